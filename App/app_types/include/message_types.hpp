@@ -6,6 +6,8 @@
 
 #include <cstdint>
 
+#include "slab_allocator.hpp"
+
 namespace message_types {
 /**
  * @brief Fixed-layout signal header for binary message transport.
@@ -94,11 +96,27 @@ struct Message
      * @brief Raw signal payload.
      *
      * Opaque binary payload associated with the signal.
-     * The payload size is fixed at compile time.
+     * The payload size is fixed at compile time; see @ref Frame for
+     * variable-length payloads.
      */
     uint8_t payload[1000];
 };
 
+/**
+ * @struct Frame
+ * @brief In-process message with a variable-length, slab-backed payload.
+ *
+ * Unlike @ref Message the payload is sized per signal (up to
+ * slab::kMaxBlock bytes) and lives in a slab::Allocator block. Create frames
+ * with slab::Allocator::make_shared<Frame>() so the frame, its control block
+ * and its payload all return to the slab when the last subscriber drops it.
+ */
+struct Frame
+{
+    SignalHeader header;    ///< Signal metadata header.
+    slab::Buffer payload;   ///< Opaque payload; empty if the slab was exhausted.
+};
+
 /**
  * @brief Compile-time verification of binary layout.
  *
@@ -1,8 +1,21 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "executor.hpp"
 #include "streams/latest_ring_buffer.hpp"
+#include "subscription_policy.hpp"
 
 namespace connection_hub {
 
@@ -11,37 +24,359 @@ class ConnectionHub {
 public:
     using MsgPtr   = std::shared_ptr<MessageT>;
     using MsgQueue = connection_hub::streams::LatestRingBuffer<MsgPtr>;
+    using Policy   = SubscriptionPolicy<MessageT>;
+    using Callback = std::function<void(const MsgPtr&)>;
+    using Stage    = std::function<void(const MessageT&)>;
 
+private:
+    /**
+     * @brief Mailbox of one filtered receiver or callback subscription.
+     *
+     * Holds the newest message its policy admitted. Publishers evaluate the
+     * policy, so a consumer is only woken for messages it will actually get.
+     *
+     * With a callback the subscription is also a Task: an admitted message
+     * schedules it once on its executor; messages arriving while it is queued
+     * or running are conflated, and it reschedules itself if it missed any.
+     * So one subscriber occupies at most one worker and never runs
+     * concurrently with itself. close() stops it and waits until it is
+     * neither queued nor running. The subscription attaches to its executor;
+     * if the executor shuts down first it cancels the subscription, which
+     * then stops scheduling and never runs again.
+     */
+    class Subscription final : public Task {
+    public:
+        explicit Subscription(Policy policy, Callback cb = {}, Executor* exec = nullptr)
+            : policy_(std::move(policy)), cb_(std::move(cb)), exec_(exec) {
+            if (exec_) exec_->attach(this);
+        }
+
+        bool needs_clock() const { return policy_.needs_clock(); }
+
+        void offer(const MsgPtr& msg, typename Policy::Clock::time_point now) {
+            bool wake = false;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                stats_.offered++;
+                if (!msg || !policy_.admit(*msg, now)) return;
+                latest_ = msg;
+                stats_.delivered++;
+                wake = waiters_ > 0;
+                // Under the lock, so cancel() cannot clear exec_ between the check and the call.
+                if (exec_ && !scheduled_) {
+                    scheduled_ = true;
+                    exec_->schedule(this);
+                }
+            }
+            if (wake) cv_.notify_all();
+        }
+
+        /// Executor side: deliver the newest message to the callback.
+        void run() override {
+            MsgPtr msg;
+            std::uint64_t taken = 0;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (closed_) {
+                    scheduled_ = false;
+                    cv_.notify_all();
+                    return;
+                }
+                msg = latest_;
+                taken = stats_.delivered;
+                runner_ = std::this_thread::get_id();
+            }
+
+            cb_(msg);
+
+            std::lock_guard<std::mutex> lk(m_);
+            runner_ = std::thread::id{};
+            stats_.callbacks++;
+            scheduled_ = !closed_ && exec_ && stats_.delivered != taken;
+            // Requeue rather than loop, so a busy subscriber cannot starve the others.
+            if (scheduled_) exec_->schedule(this);
+            // Under the lock: close() may destroy us as soon as it sees !scheduled_.
+            if (closed_) cv_.notify_all();
+        }
+
+        /// Executor side: it shuts down, so never schedule on it again.
+        void cancel() override {
+            std::lock_guard<std::mutex> lk(m_);
+            exec_ = nullptr;
+            scheduled_ = false;
+            cv_.notify_all();
+        }
+
+        /**
+         * @brief Stop delivering; return once the task is neither queued nor running.
+         *
+         * The caller must already have removed the subscription from the hub,
+         * so no publisher can schedule it again. A task still waiting in the
+         * executor queue is taken out rather than waited for, so a callback
+         * may close another subscription on the same executor even when it
+         * occupies the only worker. Closing from its own callback would wait
+         * for itself and is caught by an assert.
+         */
+        void close() {
+            Executor* exec = nullptr;
+            {
+                std::unique_lock<std::mutex> lk(m_);
+                assert(runner_ != std::this_thread::get_id() && "Subscriber destroyed from its own callback");
+                closed_ = true;
+                if (scheduled_ && runner_ == std::thread::id{} && exec_->unschedule(this)) scheduled_ = false;
+                cv_.wait(lk, [this] { return !scheduled_; });
+                exec = std::exchange(exec_, nullptr);
+            }
+            // Not under m_: the executor may be cancelling us and holds its own lock meanwhile.
+            if (exec) exec->release(this);
+        }
+
+        std::optional<MsgPtr> try_get_latest() const {
+            std::lock_guard<std::mutex> lk(m_);
+            if (!latest_) return std::nullopt;
+            return latest_;
+        }
+
+        std::optional<MsgPtr> try_get_newer(std::uint64_t& last_seen) const {
+            std::lock_guard<std::mutex> lk(m_);
+            if (stats_.delivered == last_seen) return std::nullopt;
+            last_seen = stats_.delivered;
+            return latest_;
+        }
+
+        template <class Rep, class Period>
+        std::optional<MsgPtr> wait_newer(std::uint64_t& last_seen, std::chrono::duration<Rep, Period> timeout) const {
+            std::unique_lock<std::mutex> lk(m_);
+            if (stats_.delivered == last_seen) {
+                waiters_++;
+                cv_.wait_for(lk, timeout, [&] { return stats_.delivered != last_seen; });
+                waiters_--;
+                if (stats_.delivered == last_seen) return std::nullopt;
+            }
+            last_seen = stats_.delivered;
+            return latest_;
+        }
+
+        SubscriptionStats stats() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return stats_;
+        }
+
+    private:
+        mutable std::mutex              m_;
+        mutable std::condition_variable cv_;
+        mutable std::size_t             waiters_ = 0;
+        Policy                          policy_;
+        MsgPtr                          latest_;
+        SubscriptionStats               stats_;
+
+        Callback                        cb_;
+        Executor*                       exec_      = nullptr;
+        bool                            scheduled_ = false;   ///< Queued on or running in exec_; implies exec_.
+        bool                            closed_    = false;   ///< Unsubscribed; run() only acknowledges.
+        std::thread::id                 runner_;              ///< Worker inside cb_, if any.
+    };
+
+    /// Stages and filtered receivers of a hub; publishers walk them on every publish.
+    struct Subscriptions {
+        std::mutex                                 m;
+        std::vector<Stage>                         stages;
+        std::vector<std::unique_ptr<Subscription>> list;
+        bool                                       clocked = false;   ///< Some policy rate-limits.
+        std::atomic<bool>                          active{ false };   ///< stages or list not empty.
+
+        void offer(const MsgPtr& msg) {
+            if (!active.load(std::memory_order_acquire)) return;
+            std::lock_guard<std::mutex> lk(m);
+            if (msg) {
+                for (auto& stage : stages) stage(*msg);
+            }
+            const auto now = clocked ? Policy::Clock::now() : typename Policy::Clock::time_point{};
+            for (auto& s : list) s->offer(msg, now);
+        }
+    };
+
+public:
     class Publisher {
     public:
-        explicit Publisher(MsgQueue* q) : q_(q) {}
+        explicit Publisher(MsgQueue* q, Subscriptions* subs = nullptr) : q_(q), subs_(subs) {}
 
+        /// Publish @p msg to plain receivers and to every filtered receiver whose policy admits it.
         void publish(MsgPtr msg) {
+            if (subs_) subs_->offer(msg);
             q_->publish(std::move(msg));
         }
 
     private:
-        MsgQueue* q_;   // <-- ADD THIS
+        MsgQueue*      q_;   // <-- ADD THIS
+        Subscriptions* subs_;
     };
 
+    /**
+     * Plain receivers read the shared ring. Receivers created with a
+     * SubscriptionPolicy read their own mailbox instead; the read API is the
+     * same, and publish counts (last_seen) then count delivered messages.
+     */
     class Receiver {
     public:
-        explicit Receiver(MsgQueue* q) : q_(q) {}
+        explicit Receiver(MsgQueue* q, Subscription* sub = nullptr) : q_(q), sub_(sub) {}
+
+        std::optional<MsgPtr> try_get_latest() const {
+            return sub_ ? sub_->try_get_latest() : q_->try_get_latest();
+        }
+
+        /// Latest message if it was published after @p last_seen (see LatestRingBuffer::try_get_newer).
+        std::optional<MsgPtr> try_get_newer(std::uint64_t& last_seen) const {
+            return sub_ ? sub_->try_get_newer(last_seen) : q_->try_get_newer(last_seen);
+        }
+
+        /// Block up to @p timeout for a message newer than @p last_seen.
+        template <class Rep, class Period>
+        std::optional<MsgPtr> wait_newer(std::uint64_t& last_seen, std::chrono::duration<Rep, Period> timeout) const {
+            return sub_ ? sub_->wait_newer(last_seen, timeout) : q_->wait_newer(last_seen, timeout);
+        }
+
+        /// Delivery counters; all zero for a plain receiver.
+        SubscriptionStats stats() const { return sub_ ? sub_->stats() : SubscriptionStats{}; }
+
+    private:
+        MsgQueue*     q_;
+        Subscription* sub_;
+    };
+
+    /**
+     * @brief Owning handle of a callback subscription (see subscribe()).
+     *
+     * Destroying or reset()ting the handle unsubscribes: publishers stop
+     * offering to it, and the call waits until its callback is neither
+     * queued nor running. May be reset from another subscriber's callback,
+     * also on the same executor, but not from its own callback. Must not
+     * outlive the hub; it may outlive the executor.
+     */
+    class Subscriber {
+    public:
+        Subscriber() = default;
+        Subscriber(ConnectionHub* hub, Subscription* sub) : hub_(hub), sub_(sub) {}
+
+        Subscriber(Subscriber&& o) noexcept : hub_(o.hub_), sub_(o.sub_) { o.sub_ = nullptr; }
+        Subscriber& operator=(Subscriber&& o) noexcept {
+            if (this != &o) {
+                reset();
+                hub_ = o.hub_;
+                sub_ = o.sub_;
+                o.sub_ = nullptr;
+            }
+            return *this;
+        }
+
+        Subscriber(const Subscriber&) = delete;
+        Subscriber& operator=(const Subscriber&) = delete;
+
+        ~Subscriber() { reset(); }
+
+        /// Unsubscribe now; the handle becomes empty.
+        void reset() {
+            if (sub_) hub_->unsubscribe(sub_);
+            sub_ = nullptr;
+        }
 
-        std::optional<MsgPtr> try_get_latest() const { return q_->try_get_latest(); }
+        explicit operator bool() const { return sub_ != nullptr; }
+
+        /// Delivery counters; delivered - callbacks = messages conflated away.
+        SubscriptionStats stats() const { return sub_ ? sub_->stats() : SubscriptionStats{}; }
 
     private:
-        MsgQueue* q_;
+        ConnectionHub* hub_ = nullptr;
+        Subscription*  sub_ = nullptr;
     };
 
     explicit ConnectionHub(std::size_t capacity)
         : q_(capacity) {}     // <-- Now valid because q_ is an object
 
-    Publisher make_publisher() { return Publisher(&q_); }
+    Publisher make_publisher() { return Publisher(&q_, &subs_); }
     Receiver  make_receiver()  { return Receiver(&q_); }
 
+    /**
+     * @brief Create a receiver that only gets the messages @p policy admits.
+     *
+     * The policy runs on the publishing thread. The subscription lives as
+     * long as the hub.
+     */
+    Receiver make_receiver(Policy policy) {
+        return Receiver(&q_, add(std::make_unique<Subscription>(std::move(policy))));
+    }
+
+    /**
+     * @brief Push model: run @p callback on @p executor for every admitted message.
+     *
+     * The publisher only evaluates the policy and queues the subscription;
+     * the callback runs on an executor thread, in parallel with the other
+     * subscribers. A subscriber that is still busy when new messages arrive
+     * gets only the newest one next (conflation), so it cannot build up a
+     * backlog or block the publisher.
+     *
+     * The subscription lasts until the returned Subscriber is destroyed or
+     * reset(), which must happen before the hub goes. If the executor is
+     * destroyed first it cancels the subscription (Task::cancel): the
+     * callback stops running and the Subscriber can still be reset safely.
+     *
+     * @param callback Called with the message; may keep the pointer.
+     * @param executor Runs the callback, e.g. a WorkerPool shared by several subscribers.
+     * @param policy   Filters applied at publish time, as for make_receiver().
+     */
+    Subscriber subscribe(Callback callback, Executor& executor, Policy policy = Policy::all()) {
+        auto sub = std::make_unique<Subscription>(std::move(policy), std::move(callback), &executor);
+        return Subscriber(this, add(std::move(sub)));
+    }
+
+    /**
+     * @brief Run @p stage on the publishing thread for every published message.
+     *
+     * Stages see every message, before any receiver, and must be quick
+     * (e.g. streams::HeaderHistory::record): they run under the mutex that
+     * filtered receivers and callback subscriptions are offered under, so
+     * once a stage is installed publishers of this hub serialize on it, and
+     * a slow stage delays every publisher. A stage needs no locking of its
+     * own against other publishers for the same reason.
+     *
+     * Stages cannot be removed; they live as long as the hub, and whatever
+     * they capture must too.
+     */
+    void add_stage(Stage stage) {
+        std::lock_guard<std::mutex> lk(subs_.m);
+        subs_.stages.push_back(std::move(stage));
+        subs_.active.store(true, std::memory_order_release);
+    }
+
 private:
-    MsgQueue q_;              // <-- CHANGE from MsgQueue* to MsgQueue
+    Subscription* add(std::unique_ptr<Subscription> sub) {
+        Subscription* raw = sub.get();
+        std::lock_guard<std::mutex> lk(subs_.m);
+        subs_.clocked = subs_.clocked || raw->needs_clock();
+        subs_.list.push_back(std::move(sub));
+        subs_.active.store(true, std::memory_order_release);
+        return raw;
+    }
+
+    // Detach under the publishers' lock, then wait for the executor to let go.
+    void unsubscribe(Subscription* sub) {
+        std::unique_ptr<Subscription> owned;
+        {
+            std::lock_guard<std::mutex> lk(subs_.m);
+            auto it = std::find_if(subs_.list.begin(), subs_.list.end(),
+                                   [sub](const std::unique_ptr<Subscription>& s) { return s.get() == sub; });
+            if (it == subs_.list.end()) return;
+            owned = std::move(*it);
+            subs_.list.erase(it);
+            subs_.clocked = std::any_of(subs_.list.begin(), subs_.list.end(),
+                                        [](const std::unique_ptr<Subscription>& s) { return s->needs_clock(); });
+            subs_.active.store(!subs_.stages.empty() || !subs_.list.empty(), std::memory_order_release);
+        }
+        owned->close();
+    }
+
+    MsgQueue      q_;              // <-- CHANGE from MsgQueue* to MsgQueue
+    Subscriptions subs_;
 };
 
-} // namespace connection_hub
\ No newline at end of file
+} // namespace connection_hub
@@ -0,0 +1,197 @@
+/**
+ * @file executor.hpp
+ * @brief Executors running hub callbacks off the publishing thread.
+ */
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace connection_hub {
+
+/**
+ * @brief Unit of work an Executor runs.
+ *
+ * Tasks are intrusive and owned by the caller: scheduling one never
+ * allocates. A task must stay alive until it has run, been unscheduled or
+ * been cancelled.
+ */
+class Task {
+public:
+    virtual void run() = 0;
+
+    /**
+     * @brief The executor shuts down: the task will not run (again).
+     *
+     * Called for attached tasks and for tasks still queued, on the thread
+     * destroying the executor. The task must not schedule on it afterwards.
+     */
+    virtual void cancel() {}
+
+protected:
+    ~Task() = default;
+};
+
+/**
+ * @brief Something that runs Tasks, usually on other threads.
+ */
+class Executor {
+public:
+    virtual ~Executor() = default;
+
+    /// Queue @p task. Must not block on the task itself running.
+    virtual void schedule(Task* task) = 0;
+
+    /// Remove @p task from the queue if it is waiting there; false if not queued (or running).
+    virtual bool unschedule(Task* /*task*/) { return false; }
+
+    /// @p task may be scheduled repeatedly until release(); it is cancelled if the executor goes first.
+    virtual void attach(Task* /*task*/) {}
+
+    /// Undo attach(). Not called with the task's own locks held.
+    virtual void release(Task* /*task*/) {}
+};
+
+/**
+ * @class WorkerPool
+ * @brief Fixed set of worker threads draining one FIFO of tasks.
+ *
+ * schedule() only takes a short lock and signals one idle worker, so a
+ * publisher is never held up by slow tasks. Give a subscriber that may run
+ * long its own pool to keep it from occupying the shared workers.
+ *
+ * Destroying the pool stops the workers after their current task, then
+ * cancels (Task::cancel) every attached task and every task still queued.
+ * Hub subscriptions attach themselves, so the pool may go before or after
+ * them: a cancelled subscription just stops delivering.
+ */
+class WorkerPool : public Executor {
+public:
+    /**
+     * @brief Start @p threads workers.
+     *
+     * @param threads Number of workers (at least one is started).
+     * @param onStart Optional hook run first on each worker with its index
+     *                (thread naming, CPU affinity, measurement).
+     */
+    explicit WorkerPool(std::size_t threads, std::function<void(std::size_t)> onStart = {})
+        : queue_(16)
+    {
+        if (threads == 0) threads = 1;
+        workers_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this, i, onStart] {
+                if (onStart) onStart(i);
+                work();
+            });
+        }
+    }
+
+    ~WorkerPool() override {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+
+        // One at a time without holding m_: cancel() takes the task's own lock,
+        // and release() of the task being cancelled waits until it is done.
+        std::unique_lock<std::mutex> lk(m_);
+        for (; count_ > 0; count_--, head_ = (head_ + 1) % queue_.size()) {
+            Task* t = queue_[head_];
+            if (std::find(attached_.begin(), attached_.end(), t) == attached_.end()) attached_.push_back(t);
+        }
+        while (!attached_.empty()) {
+            cancelling_ = attached_.back();
+            attached_.pop_back();
+            lk.unlock();
+            cancelling_->cancel();
+            lk.lock();
+            cancelling_ = nullptr;
+            cv_.notify_all();
+        }
+    }
+
+    /// Non-copyable.
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void schedule(Task* task) override {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            if (count_ == queue_.size()) grow();
+            queue_[(head_ + count_) % queue_.size()] = task;
+            count_++;
+        }
+        cv_.notify_one();
+    }
+
+    bool unschedule(Task* task) override {
+        std::lock_guard<std::mutex> lk(m_);
+        for (std::size_t i = 0; i < count_; ++i) {
+            if (queue_[(head_ + i) % queue_.size()] != task) continue;
+            for (std::size_t j = i + 1; j < count_; ++j) {
+                queue_[(head_ + j - 1) % queue_.size()] = queue_[(head_ + j) % queue_.size()];
+            }
+            count_--;
+            return true;
+        }
+        return false;
+    }
+
+    void attach(Task* task) override {
+        std::lock_guard<std::mutex> lk(m_);
+        attached_.push_back(task);
+    }
+
+    void release(Task* task) override {
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait(lk, [&] { return cancelling_ != task; });
+        attached_.erase(std::remove(attached_.begin(), attached_.end(), task), attached_.end());
+    }
+
+    /// Number of worker threads.
+    std::size_t size() const { return workers_.size(); }
+
+private:
+    void work() {
+        std::unique_lock<std::mutex> lk(m_);
+        while (true) {
+            cv_.wait(lk, [this] { return stop_ || count_ > 0; });
+            if (stop_) return;
+
+            Task* task = queue_[head_];
+            head_ = (head_ + 1) % queue_.size();
+            count_--;
+
+            lk.unlock();
+            task->run();
+            lk.lock();
+        }
+    }
+
+    // Ring buffer of pending tasks; grows (rarely) instead of blocking schedule().
+    void grow() {
+        std::vector<Task*> bigger(queue_.size() * 2);
+        for (std::size_t i = 0; i < count_; ++i) bigger[i] = queue_[(head_ + i) % queue_.size()];
+        queue_.swap(bigger);
+        head_ = 0;
+    }
+
+    std::mutex               m_;
+    std::condition_variable  cv_;
+    std::vector<Task*>       queue_;
+    std::size_t              head_  = 0;
+    std::size_t              count_ = 0;
+    bool                     stop_  = false;
+    std::vector<Task*>       attached_;              ///< See attach(); cancelled on destruction.
+    Task*                    cancelling_ = nullptr;  ///< Being cancelled by the destructor.
+    std::vector<std::thread> workers_;
+};
+
+} // namespace connection_hub
@@ -0,0 +1,198 @@
+/**
+ * @file message_pool.hpp
+ * @brief Recycling pool of shared messages for allocation-free publishing.
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace connection_hub {
+
+/**
+ * @class MessagePool
+ * @brief Hands out std::shared_ptr<T> whose objects and control blocks are recycled.
+ *
+ * All objects are created up front. When the last reference to a message
+ * is dropped, the object goes back to the pool instead of being destroyed,
+ * and its control block goes back to a free list, so a warmed-up
+ * publish/consume cycle never calls the system allocator.
+ *
+ * Objects come back with their previous contents; callers overwrite them.
+ * For protobuf messages reset fields in place (mutable_x()->Clear(),
+ * mutable_bytes()->clear()): the top-level Clear() deletes sub-messages.
+ *
+ * The capacity must cover every message that can be alive at once:
+ * hub depth + one per receiver + the one being filled. If the pool runs dry
+ * acquire() falls back to the heap and overflow() counts it.
+ *
+ * Thread-safe. Messages may outlive the pool object itself.
+ *
+ * @tparam T Default-constructible message type.
+ */
+template <typename T>
+class MessagePool {
+public:
+    /**
+     * @brief Create @p capacity objects and warm up their control blocks.
+     */
+    explicit MessagePool(std::size_t capacity)
+        : state_(std::make_shared<State>(capacity))
+    {
+        // Run every object through acquire/release once so the control
+        // blocks exist before the steady state begins.
+        std::vector<std::shared_ptr<T>> warm;
+        warm.reserve(capacity);
+        for (std::size_t i = 0; i < capacity; ++i) warm.push_back(acquire());
+    }
+
+    /// Non-copyable.
+    MessagePool(const MessagePool&) = delete;
+    MessagePool& operator=(const MessagePool&) = delete;
+
+    /**
+     * @brief Take a message from the pool.
+     *
+     * @return Message returned to the pool when its last reference is released.
+     */
+    std::shared_ptr<T> acquire() {
+        T* obj = state_->pop();
+        return std::shared_ptr<T>(obj, Recycler{ state_.get() }, BlockAllocator<T>{ state_ });
+    }
+
+    /// Objects currently available without falling back to the heap.
+    std::size_t available() const {
+        std::lock_guard<std::mutex> lk(state_->m);
+        return state_->free.size();
+    }
+
+    /// Number of acquire() calls that had to allocate a new object.
+    std::uint64_t overflow() const {
+        std::lock_guard<std::mutex> lk(state_->m);
+        return state_->overflow;
+    }
+
+private:
+    /// Shared with every outstanding message so it outlives the pool if needed.
+    struct State {
+        explicit State(std::size_t capacity) : capacity(capacity) {
+            objects.reserve(capacity);
+            free.reserve(capacity);
+            blocks.reserve(capacity);
+            for (std::size_t i = 0; i < capacity; ++i) {
+                objects.push_back(std::make_unique<T>());
+                free.push_back(objects.back().get());
+            }
+        }
+
+        ~State() {
+            for (void* b : blocks) ::operator delete(b);
+        }
+
+        T* pop() {
+            {
+                std::lock_guard<std::mutex> lk(m);
+                if (!free.empty()) {
+                    T* obj = free.back();
+                    free.pop_back();
+                    return obj;
+                }
+                overflow++;
+            }
+            return new T();
+        }
+
+        // Pool-owned objects go back on the free list; overflow objects are deleted.
+        void push(T* obj) {
+            {
+                std::lock_guard<std::mutex> lk(m);
+                if (free.size() < capacity && owns(obj)) {
+                    free.push_back(obj);
+                    return;
+                }
+            }
+            delete obj;
+        }
+
+        bool owns(const T* obj) const {
+            for (const auto& o : objects) if (o.get() == obj) return true;
+            return false;
+        }
+
+        // Control blocks all have the same size for a given T.
+        void* take_block(std::size_t bytes) {
+            {
+                std::lock_guard<std::mutex> lk(m);
+                if (!blocks.empty() && bytes <= blockSize) {
+                    void* b = blocks.back();
+                    blocks.pop_back();
+                    return b;
+                }
+                if (blockSize == 0) blockSize = bytes;
+            }
+            return ::operator new(bytes < blockSize ? blockSize : bytes);
+        }
+
+        void give_block(void* b, std::size_t bytes) {
+            {
+                std::lock_guard<std::mutex> lk(m);
+                if (bytes <= blockSize && blocks.size() < capacity) {
+                    blocks.push_back(b);
+                    return;
+                }
+            }
+            ::operator delete(b);
+        }
+
+        const std::size_t               capacity;
+        mutable std::mutex              m;
+        std::vector<std::unique_ptr<T>> objects;
+        std::vector<T*>                 free;
+        std::vector<void*>              blocks;
+        std::size_t                     blockSize = 0;
+        std::uint64_t                   overflow = 0;
+    };
+
+    /// Deleter: returns the object to the pool.
+    struct Recycler {
+        State* state;
+        void operator()(T* obj) const { state->push(obj); }
+    };
+
+    /**
+     * @brief Allocator for shared_ptr control blocks backed by the pool's free list.
+     *
+     * The allocator, not the deleter, keeps the state alive: the control block
+     * destroys its deleter before handing its own memory back to the allocator.
+     */
+    template <typename U>
+    struct BlockAllocator {
+        using value_type = U;
+
+        std::shared_ptr<State> state;
+
+        BlockAllocator(std::shared_ptr<State> s) : state(std::move(s)) {}
+        template <typename V>
+        BlockAllocator(const BlockAllocator<V>& other) : state(other.state) {}
+
+        U* allocate(std::size_t n) {
+            return static_cast<U*>(state->take_block(n * sizeof(U)));
+        }
+        void deallocate(U* p, std::size_t n) {
+            state->give_block(p, n * sizeof(U));
+        }
+
+        template <typename V>
+        bool operator==(const BlockAllocator<V>& o) const { return state == o.state; }
+        template <typename V>
+        bool operator!=(const BlockAllocator<V>& o) const { return state != o.state; }
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+} // namespace connection_hub
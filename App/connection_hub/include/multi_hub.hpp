@@ -0,0 +1,281 @@
+/**
+ * @file multi_hub.hpp
+ * @brief Typed multi-channel hub and single-thread dispatcher.
+ *
+ * MultiHub carries several message types through one registry. Each type
+ * gets its own LatestRingBuffer channel, selected at compile time, and all
+ * channels share one doorbell so a single consumer thread can sleep until
+ * any of them is published.
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "streams/latest_ring_buffer.hpp"
+
+namespace connection_hub {
+
+namespace detail {
+
+/// Index of @p T in @p Ts (compile error if absent).
+template <typename T, typename... Ts>
+struct IndexOf;
+
+template <typename T, typename... Ts>
+struct IndexOf<T, T, Ts...> : std::integral_constant<std::size_t, 0> {};
+
+template <typename T, typename U, typename... Ts>
+struct IndexOf<T, U, Ts...> : std::integral_constant<std::size_t, 1 + IndexOf<T, Ts...>::value> {};
+
+/// True if @p T appears exactly once in @p Ts.
+template <typename T, typename... Ts>
+inline constexpr bool kOccursOnce = (std::size_t{0} + ... + std::is_same_v<T, Ts>) == 1;
+
+} // namespace detail
+
+/**
+ * @class MultiHub
+ * @brief Hub carrying several message types identified at compile time.
+ *
+ * Every type in @p MessageTs owns a separate latest-value channel. Publishers
+ * and receivers are typed per message, so routing is resolved entirely at
+ * compile time. Publishing any type rings a shared doorbell that
+ * wait_for_publish() can block on.
+ *
+ * @tparam MessageTs Distinct message types carried by the hub.
+ */
+template <typename... MessageTs>
+class MultiHub {
+    static_assert(sizeof...(MessageTs) > 0, "MultiHub needs at least one message type");
+    static_assert((detail::kOccursOnce<MessageTs, MessageTs...> && ...),
+                  "MultiHub message types must be distinct");
+
+public:
+    template <typename T> using MsgPtr   = std::shared_ptr<T>;
+    template <typename T> using MsgQueue = connection_hub::streams::LatestRingBuffer<MsgPtr<T>>;
+
+    /// Number of message types carried by the hub.
+    static constexpr std::size_t kTypeCount = sizeof...(MessageTs);
+
+    /// Compile-time channel index of @p T.
+    template <typename T>
+    static constexpr std::size_t index_of() {
+        static_assert(detail::kOccursOnce<T, MessageTs...>, "type is not carried by this MultiHub");
+        return detail::IndexOf<T, MessageTs...>::value;
+    }
+
+    template <typename T>
+    class Publisher {
+    public:
+        explicit Publisher(MultiHub* hub) : hub_(hub) {}
+
+        void publish(MsgPtr<T> msg) {
+            hub_->template channel<T>().publish(std::move(msg));
+            hub_->ring();
+        }
+
+    private:
+        MultiHub* hub_;
+    };
+
+    template <typename T>
+    class Receiver {
+    public:
+        explicit Receiver(const MsgQueue<T>* q) : q_(q) {}
+
+        std::optional<MsgPtr<T>> try_get_latest() const { return q_->try_get_latest(); }
+        std::optional<MsgPtr<T>> try_get_newer(std::uint64_t& last_seen) const { return q_->try_get_newer(last_seen); }
+
+    private:
+        const MsgQueue<T>* q_;
+    };
+
+    /**
+     * @brief Create the hub with one channel of @p capacity slots per type.
+     *
+     * @throws std::invalid_argument If @p capacity is zero.
+     */
+    explicit MultiHub(std::size_t capacity)
+        : channels_(capacity_for<MessageTs>(capacity)...) {}
+
+    /// Non-copyable; publishers and receivers keep a pointer to the hub.
+    MultiHub(const MultiHub&) = delete;
+    MultiHub& operator=(const MultiHub&) = delete;
+
+    template <typename T> Publisher<T> make_publisher() { return Publisher<T>(this); }
+    template <typename T> Receiver<T>  make_receiver() const { return Receiver<T>(&channel<T>()); }
+
+    /// Channel of type @p T.
+    template <typename T>
+    MsgQueue<T>& channel() { return std::get<index_of<T>()>(channels_); }
+
+    template <typename T>
+    const MsgQueue<T>& channel() const { return std::get<index_of<T>()>(channels_); }
+
+    /// Total number of publishes across all channels.
+    std::uint64_t publish_count() const { return rings_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Block until any channel has been published after @p seen, or timeout.
+     *
+     * @param seen    Value of publish_count() observed before the caller last checked the channels.
+     * @param timeout Maximum time to block.
+     * @return Current publish_count().
+     */
+    std::uint64_t wait_for_publish(std::uint64_t seen, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lk(m_);
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        cv_.wait_for(lk, timeout, [&] { return rings_.load(std::memory_order_seq_cst) != seen; });
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return rings_.load(std::memory_order_acquire);
+    }
+
+private:
+    // Expands the capacity once per type; each channel is built in place.
+    template <typename>
+    static constexpr std::size_t capacity_for(std::size_t capacity) { return capacity; }
+
+    // Publishers only touch the mutex when a consumer is actually sleeping.
+    void ring() {
+        rings_.fetch_add(1, std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_seq_cst) != 0) {
+            { std::lock_guard<std::mutex> lk(m_); }
+            cv_.notify_all();
+        }
+    }
+
+    std::tuple<MsgQueue<MessageTs>...> channels_;
+
+    std::atomic<std::uint64_t> rings_{0};
+    std::atomic<std::uint32_t> waiters_{0};
+    std::mutex                 m_;
+    std::condition_variable    cv_;
+};
+
+/**
+ * @class Dispatcher
+ * @brief Routes every message type of a MultiHub to its handlers from one thread.
+ *
+ * The handlers are stored by value as their own types, and routing is done
+ * at compile time: a handler receives every carried type T it is invocable
+ * with as f(const std::shared_ptr<T>&). Dispatch walks the type list with a
+ * fold, so each delivery is a direct (inlinable) call, with no type erasure,
+ * dynamic_cast or virtual call. Types no handler accepts are never polled.
+ *
+ * Create one with make_dispatcher(). Dispatcher is not thread-safe: drive it
+ * from a single consumer thread.
+ *
+ * @tparam HubT A MultiHub specialization.
+ * @tparam Fs   Handler types; each must accept at least one carried type.
+ */
+template <typename HubT, typename... Fs>
+class Dispatcher;
+
+template <typename... MessageTs, typename... Fs>
+class Dispatcher<MultiHub<MessageTs...>, Fs...> {
+public:
+    using Hub = MultiHub<MessageTs...>;
+
+    /// True if handler @p F is called for messages of type @p T.
+    template <typename F, typename T>
+    static constexpr bool kAccepts = std::is_invocable_v<F&, const std::shared_ptr<T>&>;
+
+    /// True if handler @p F is called for at least one carried type.
+    template <typename F>
+    static constexpr bool kUsed = (kAccepts<F, MessageTs> || ...);
+
+    static_assert((kUsed<Fs> && ...),
+                  "every Dispatcher handler must accept at least one message type of the hub");
+
+    Dispatcher(Hub& hub, Fs... handlers) : hub_(hub), handlers_(std::move(handlers)...) {}
+
+    /**
+     * @brief Deliver the latest unseen message of every type to its handlers.
+     *
+     * @return Number of messages delivered (at most one per type).
+     */
+    std::size_t dispatch_once() {
+        return dispatch_all(std::index_sequence_for<MessageTs...>{});
+    }
+
+    /**
+     * @brief Dispatch until @p running is false, sleeping while no channel changes.
+     *
+     * @param running Cleared by another thread to stop the loop.
+     * @param idle    Upper bound on a single sleep, so @p running is rechecked.
+     */
+    void run(const std::atomic<bool>& running,
+             std::chrono::milliseconds idle = std::chrono::milliseconds{100}) {
+        while (running.load(std::memory_order_relaxed)) {
+            const std::uint64_t seen = hub_.publish_count();
+            if (dispatch_once() == 0) {
+                hub_.wait_for_publish(seen, idle);
+            }
+        }
+    }
+
+private:
+    template <std::size_t... I>
+    std::size_t dispatch_all(std::index_sequence<I...>) {
+        return (std::size_t{0} + ... + dispatch_type<MessageTs, I>());
+    }
+
+    template <typename T, std::size_t I>
+    std::size_t dispatch_type() {
+        if constexpr (!(kAccepts<Fs, T> || ...)) {
+            return 0;
+        } else {
+            auto m = hub_.template channel<T>().try_get_newer(last_seen_[I]);
+            if (!m) {
+                return 0;
+            }
+            deliver(*m, std::index_sequence_for<Fs...>{});
+            return 1;
+        }
+    }
+
+    // Handlers run in registration order.
+    template <typename T, std::size_t... J>
+    void deliver(const std::shared_ptr<T>& msg, std::index_sequence<J...>) {
+        (deliver_to<J>(msg), ...);
+    }
+
+    template <std::size_t J, typename T>
+    void deliver_to(const std::shared_ptr<T>& msg) {
+        auto& handler = std::get<J>(handlers_);
+        if constexpr (kAccepts<std::decay_t<decltype(handler)>, T>) {
+            handler(msg);
+        }
+    }
+
+    Hub& hub_;
+    std::tuple<Fs...> handlers_;
+    std::uint64_t last_seen_[sizeof...(MessageTs)] = {};
+};
+
+/**
+ * @brief Create a Dispatcher for @p hub with @p handlers (lambdas, function objects).
+ *
+ * @code
+ * auto d = make_dispatcher(hub,
+ *     [](const std::shared_ptr<Imu>& m)   { ... },
+ *     [](const std::shared_ptr<Radar>& m) { ... });
+ * d.run(running);
+ * @endcode
+ */
+template <typename... MessageTs, typename... Fs>
+Dispatcher<MultiHub<MessageTs...>, std::decay_t<Fs>...>
+make_dispatcher(MultiHub<MessageTs...>& hub, Fs&&... handlers) {
+    return Dispatcher<MultiHub<MessageTs...>, std::decay_t<Fs>...>(hub, std::forward<Fs>(handlers)...);
+}
+
+} // namespace connection_hub
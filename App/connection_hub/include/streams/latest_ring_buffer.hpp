@@ -5,6 +5,7 @@
 #pragma once
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <mutex>
 #include <optional>
 #include <utility>
@@ -12,6 +13,8 @@
 #include <chrono>
 #include <stdexcept>
 
+#include "trace.hpp"
+
 namespace connection_hub::streams {
 /**
  * @class LatestRingBuffer
@@ -72,6 +75,8 @@ public:
    * @param value Value to publish.
    */
   void publish(T value) {
+    TRACE_SCOPE("LatestRingBuffer::publish");
+    bool wake = false;
     {
       std::lock_guard<std::mutex> lk(m_);
 
@@ -80,6 +85,11 @@ public:
       write_ = (write_ + 1) % cap_;
 
       has_value_ = true;
+      published_++;
+      wake = waiters_ > 0;
+    }
+    if (wake) {
+      cv_.notify_all();
     }
   }
 
@@ -92,6 +102,7 @@ public:
    * @return Latest value or std::nullopt if the buffer is empty.
    */
   std::optional<T> try_get_latest() const {
+    TRACE_SCOPE("LatestRingBuffer::try_get_latest");
     std::lock_guard<std::mutex> lk(m_);
 
     if (!has_value_) 
@@ -102,6 +113,63 @@ public:
     return buf_[latest_index_]; // copy (for shared_ptr: cheap)
   }
 
+  /**
+   * @brief Retrieve the latest value only if it was published after @p last_seen.
+   *
+   * @p last_seen is the publish count observed by the caller on its previous
+   * successful call (0 initially). On success it is updated to the current
+   * publish count, so each published value is returned at most once per caller.
+   *
+   * @param last_seen In/out publish count of the last value consumed.
+   * @return Latest value or std::nullopt if nothing new was published.
+   */
+  std::optional<T> try_get_newer(std::uint64_t& last_seen) const {
+    TRACE_SCOPE("LatestRingBuffer::try_get_newer");
+    std::lock_guard<std::mutex> lk(m_);
+
+    if (published_ == last_seen)
+    {
+      return std::nullopt;
+    }
+
+    last_seen = published_;
+    return buf_[latest_index_];
+  }
+
+  /**
+   * @brief Blocking variant of try_get_newer().
+   *
+   * Waits up to @p timeout for a value published after @p last_seen.
+   * Publishers only signal when someone is waiting.
+   *
+   * @param last_seen In/out publish count of the last value consumed.
+   * @param timeout   Maximum time to block.
+   * @return Latest value or std::nullopt on timeout.
+   */
+  template <class Rep, class Period>
+  std::optional<T> wait_newer(std::uint64_t& last_seen, std::chrono::duration<Rep, Period> timeout) const {
+    std::unique_lock<std::mutex> lk(m_);
+    if (published_ == last_seen) {
+      waiters_++;
+      cv_.wait_for(lk, timeout, [&] { return published_ != last_seen; });
+      waiters_--;
+      if (published_ == last_seen) {
+        return std::nullopt;
+      }
+    }
+
+    last_seen = published_;
+    return buf_[latest_index_];
+  }
+
+  /**
+   * @brief Total number of values published since construction.
+   */
+  std::uint64_t publish_count() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return published_;
+  }
+
   /**
    * @brief Obtain a snapshot of the internal buffer state.
    *
@@ -124,11 +192,14 @@ public:
 private:
   const std::size_t cap_;
   mutable std::mutex m_;
+  mutable std::condition_variable cv_;
+  mutable std::size_t waiters_ = 0;
   std::vector<T> buf_;
 
   std::size_t write_ = 0;
   std::size_t latest_index_ = 0;
   bool has_value_ = false;
+  std::uint64_t published_ = 0;
 };
 
 } // namespace connection_hub::streams 
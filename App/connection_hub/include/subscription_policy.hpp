@@ -0,0 +1,123 @@
+/**
+ * @file subscription_policy.hpp
+ * @brief Per-subscriber delivery policies evaluated by the hub at publish time.
+ */
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace connection_hub {
+
+/**
+ * @brief Delivery counters of one filtered receiver or callback subscription.
+ */
+struct SubscriptionStats {
+    std::uint64_t offered   = 0;  ///< Messages published since the receiver was created.
+    std::uint64_t delivered = 0;  ///< Messages admitted by the policy.
+    std::uint64_t callbacks = 0;  ///< Callback runs (callback subscriptions; fewer than delivered when conflated).
+};
+
+/**
+ * @class SubscriptionPolicy
+ * @brief Decides which published messages reach one receiver.
+ *
+ * A policy combines up to three filters, applied in this order; each one
+ * only sees the messages that passed the previous one:
+ *
+ *  1. on_change(key): deliver only when key(msg) differs from the last delivered key.
+ *  2. every_nth(n):   deliver one message out of @p n.
+ *  3. max_rate(hz):   deliver at most @p hz messages per second.
+ *
+ * A filtered receiver always holds only the newest admitted message, so a
+ * consumer that falls behind is conflated to the latest value.
+ *
+ * @tparam MessageT Hub message type (the key function sees the message, not the pointer).
+ */
+template <typename MessageT>
+class SubscriptionPolicy {
+public:
+    using Clock  = std::chrono::steady_clock;
+    using KeyFn  = std::function<std::uint64_t(const MessageT&)>;
+
+    /// Deliver everything (same as an unfiltered receiver).
+    static SubscriptionPolicy all() { return SubscriptionPolicy{}; }
+
+    /// Deliver one message out of @p n (the first, the (n+1)th, ...).
+    static SubscriptionPolicy every_nth(std::uint32_t n) { return all().nth(n); }
+
+    /// Deliver at most @p hz messages per second.
+    static SubscriptionPolicy max_rate(double hz) { return all().rate(hz); }
+
+    /// Deliver only when @p key changes (the first message always passes).
+    static SubscriptionPolicy on_change(KeyFn key) { return all().change(std::move(key)); }
+
+    /// Add or replace the decimation filter.
+    SubscriptionPolicy& nth(std::uint32_t n) {
+        every_ = (n == 0) ? 1 : n;
+        return *this;
+    }
+
+    /// Add or replace the rate limit; @p hz <= 0 removes it.
+    SubscriptionPolicy& rate(double hz) {
+        interval_ = (hz > 0.0)
+            ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz))
+            : Clock::duration::zero();
+        return *this;
+    }
+
+    /// Add or replace the change filter.
+    SubscriptionPolicy& change(KeyFn key) {
+        key_ = std::move(key);
+        return *this;
+    }
+
+    /// True if the rate filter needs the publish time.
+    bool needs_clock() const { return interval_ > Clock::duration::zero(); }
+
+    /**
+     * @brief Run @p msg through the filters and update their state.
+     *
+     * Called by the hub under the subscription's lock, once per publish.
+     *
+     * @param now Publish time; only read when needs_clock() is true.
+     * @return true if the message should be delivered.
+     */
+    bool admit(const MessageT& msg, Clock::time_point now) {
+        std::uint64_t k = 0;
+        if (key_) {
+            k = key_(msg);
+            if (have_key_ && k == last_key_) return false;
+        }
+
+        if (every_ > 1) {
+            const bool pass = (seen_ % every_) == 0;
+            seen_++;
+            if (!pass) return false;
+        }
+
+        if (needs_clock()) {
+            if (now < next_due_) return false;
+            // Stay on the grid so jitter does not lower the rate; resync after a gap.
+            next_due_ = (next_due_ + interval_ > now) ? next_due_ + interval_ : now + interval_;
+        }
+
+        if (key_) {
+            have_key_ = true;
+            last_key_ = k;
+        }
+        return true;
+    }
+
+private:
+    std::uint32_t     every_    = 1;
+    Clock::duration   interval_ = Clock::duration::zero();
+    KeyFn             key_;
+
+    std::uint64_t     seen_     = 0;
+    Clock::time_point next_due_{};
+    std::uint64_t     last_key_ = 0;
+    bool              have_key_ = false;
+};
+
+} // namespace connection_hub
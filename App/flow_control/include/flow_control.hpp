@@ -6,17 +6,25 @@
  * through repeating phases. Each phase defines which participants are allowed
  * to proceed; when all participants in a phase report completion, the next
  * phase becomes active.
+ *
+ * Phases carry a time budget and a priority. A participant that misses the
+ * phase deadline is skipped instead of stalling everyone: the phase advances,
+ * the straggler's late done() is ignored, and it rejoins on its next turn.
  */
 #pragma once
 #include <condition_variable>
+#include <array>
+#include <algorithm>
 #include <chrono>
+#include <limits>
 #include <mutex>
-#include <unordered_set>
 #include <vector>
 #include <iostream>
 #include <cassert>
 #include <cstdint>
 
+#include "trace.hpp"
+
 namespace flow_control {
 
 /**
@@ -24,6 +32,9 @@ namespace flow_control {
  */
 enum class Id : std::uint8_t { A, B, C };
 
+/// Number of values in @ref Id (keep in sync with the enum).
+inline constexpr std::size_t kIdCount = 3;
+
 /**
  * @brief Hash functor for Id to allow use in unordered containers.
  */
@@ -33,6 +44,42 @@ struct IdHash {
     }
 };
 
+/**
+ * @brief How a phase reacts when a participant misses its budget.
+ */
+enum class Priority : std::uint8_t {
+    Critical,    ///< Stragglers get until the wait timeout before being skipped.
+    BestEffort   ///< Stragglers are skipped as soon as the budget expires.
+};
+
+/**
+ * @brief Result of FlowControl::wait_turn().
+ */
+enum class TurnStatus : std::uint8_t {
+    Granted,   ///< The caller owns a turn in the current phase.
+    TimedOut   ///< No turn within the wait timeout; skip the work for this cycle.
+};
+
+/**
+ * @brief Degradation counters of one participant.
+ */
+struct ParticipantStats {
+    std::uint64_t turns        = 0;  ///< Turns granted by wait_turn().
+    std::uint64_t skipped      = 0;  ///< Phases advanced without this participant.
+    std::uint64_t lateDone     = 0;  ///< done() calls ignored because the phase had moved on.
+    std::uint64_t overruns     = 0;  ///< done() on time for the phase but after its budget.
+    std::uint64_t waitTimeouts = 0;  ///< wait_turn() calls that returned TimedOut.
+};
+
+/**
+ * @brief Snapshot of all FlowControl counters.
+ */
+struct Stats {
+    std::uint64_t phasesCompleted = 0;  ///< Phases finished by every participant.
+    std::uint64_t phasesExpired   = 0;  ///< Phases advanced with stragglers skipped.
+    std::array<ParticipantStats, kIdCount> participants{};  ///< Indexed by Id.
+};
+
 /**
  * @class FlowControl
  * @brief Coordinates multiple participants through a fixed sequence of phases.
@@ -44,16 +91,36 @@ struct IdHash {
  * When all expected participants for the current phase have called done(), the
  * controller advances to the next phase (wrapping around to the first).
  *
- * @note This class uses assertions for contract violations and reports timeouts
- *       to stderr before asserting.
+ * If the phase deadline passes first (see PhaseSpec), any waiting or finishing
+ * participant expires the phase: the missing participants are counted as
+ * skipped and the next phase starts. Nothing asserts on lateness; done()
+ * without an open turn (never granted, or a second done() for the same
+ * turn) is still treated as a contract violation.
  */
 class FlowControl {
 public:
+    using Clock = std::chrono::steady_clock;
+
     /// A phase is an ordered list of participants expected to run in that phase.
     using Phase = std::vector<Id>;
 
     /**
-     * @brief Construct a phase controller.
+     * @brief Phase with its time budget and priority.
+     *
+     * The budget is measured from the moment the phase becomes active.
+     * A zero budget means "no budget": the phase only expires after the wait
+     * timeout, like a Critical phase.
+     */
+    struct PhaseSpec {
+        Phase ids;
+        std::chrono::milliseconds budget{0};
+        Priority priority = Priority::Critical;
+    };
+
+    /**
+     * @brief Construct a phase controller without budgets.
+     *
+     * Every phase is Critical: a straggler is skipped after @p timeout_each_wait.
      *
      * @param phases Sequence of phases. Each phase must be non-empty.
      * @param timeout_each_wait Maximum time wait_turn() will block before timing out.
@@ -62,9 +129,25 @@ public:
      */
     FlowControl(std::vector<Phase> phases,
                 std::chrono::milliseconds timeout_each_wait)
+        : FlowControl(to_specs(std::move(phases)), timeout_each_wait)
+    {
+    }
+
+    /**
+     * @brief Construct a phase controller with per-phase budgets and priorities.
+     *
+     * @param phases Sequence of phase specs. Each phase must be non-empty.
+     * @param timeout_each_wait Maximum time wait_turn() will block, and the
+     *                          deadline of Critical phases.
+     *
+     * @pre @p phases is not empty and each phase contains at least one Id.
+     */
+    FlowControl(std::vector<PhaseSpec> phases,
+                std::chrono::milliseconds timeout_each_wait)
         : phases_(std::move(phases)), timeout_(timeout_each_wait)
     {
         assert(!phases_.empty());
+        turn_gen_.fill(std::numeric_limits<std::uint64_t>::max());
         rebuild_expected_for_current_phase();
     }
 
@@ -72,40 +155,45 @@ public:
      * @brief Block until @p who is allowed to execute in the current phase.
      *
      * This call returns when @p who is part of the current phase and has not yet
-     * completed it. If the wait exceeds the configured timeout, the function
-     * reports an error and asserts.
+     * completed it. While waiting, the caller expires the current phase if its
+     * deadline passes. If no turn is granted within the configured timeout the
+     * call reports a warning and returns TurnStatus::TimedOut.
      *
      * @param who Participant requesting a turn.
+     * @return Granted, or TimedOut if the caller should skip this cycle.
      */
-    void wait_turn(Id who) {
-        
+    TurnStatus wait_turn(Id who) {
+        TRACE_SCOPE("FlowControl::wait_turn");
+
         /**
          * Important note: means exclusive locking
-         */ 
+         */
         std::unique_lock<std::mutex> lk(m_);
+        const auto give_up = Clock::now() + timeout_;
+
         /**
          * Important note:
-         * wait_for(...) blocks the current thread until either:
-         *  - the predicate becomes true 
-         *  - the timeout expires.
-         * is allowed in the current phase and has not already completed it.
-         */ 
-        bool ok = cv_.wait_for(lk, timeout_, [&] {
-            /**
-             * Important note:
-             * Must check both expected_ and done_ to ensure the caller
-             * expected_ is an unordered_set<Id, IdHash> containing Ids that are allowed in the current phase
-             * .count(who) returns:
-             *   - 1 if who is in the set
-             *   - 0 otherwise
-             */ 
-            return expected_.count(who) != 0 && done_.count(who) == 0;
-        });
-
-        if (!ok) {
-            std::cerr << "[ERROR] Timeout waiting (phase=" << phase_idx_ << ")\n";
-            assert(false && "FlowControl timeout");
+         * wait_until(...) wakes up at the earlier of our own timeout and the
+         * phase deadline, so a blocked participant is also the one that
+         * notices an overdue phase and moves the cycle on.
+         */
+        while (!may_run(who)) {
+            if (expire_if_overdue_unlocked() && may_run(who)) {
+                break;
+            }
+            if (Clock::now() >= give_up) {
+                stats_.participants[index(who)].waitTimeouts++;
+                std::cerr << "[WARN] FlowControl: participant " << name(who)
+                          << " timed out waiting (phase=" << phase_idx_ << ")\n";
+                return TurnStatus::TimedOut;
+            }
+            cv_.wait_until(lk, std::min(give_up, phase_deadline_));
         }
+
+        turn_gen_[index(who)] = generation_;
+        in_turn_[index(who)] = true;
+        stats_.participants[index(who)].turns++;
+        return TurnStatus::Granted;
     }
 
     /**
@@ -114,63 +202,156 @@ public:
      * When all expected participants in the current phase have reported done(),
      * FlowControl advances to the next phase and wakes waiting participants.
      *
+     * If the phase @p who was granted has already expired, the call is counted
+     * as a late done() and otherwise ignored; @p who simply waits for its next
+     * turn.
+     *
      * @param who Participant completing its work for the phase.
      *
-     * @pre @p who is part of the current phase.
-     * @pre @p who has not already called done() in the current phase.
+     * @pre @p who holds a turn from wait_turn() and has not already called
+     *      done() for it.
      */
     void done(Id who) {
+        TRACE_SCOPE("FlowControl::done");
         bool notify = false;
         {
             std::lock_guard<std::mutex> lk(m_);
+            ParticipantStats& ps = stats_.participants[index(who)];
+
+            if (!in_turn_[index(who)]) {
+                if (turn_gen_[index(who)] == generation_) {
+                    std::cerr << "[ERROR] done() called twice in same phase (phase=" << phase_idx_ << ")\n";
+                    assert(false && "double done()");
+                } else {
+                    std::cerr << "[ERROR] done() called out of phase (phase=" << phase_idx_ << ")\n";
+                    assert(false && "done() called out of phase");
+                }
+                return;
+            }
+            in_turn_[index(who)] = false;
 
-            if (expected_.count(who) == 0) {
-                std::cerr << "[ERROR] done() called out of phase (phase=" << phase_idx_ << ")\n";
-                assert(false && "done() called out of phase");
+            if (turn_gen_[index(who)] != generation_) {
+                // Skipped straggler: rejoin on the next turn.
+                ps.lateDone++;
+                return;
             }
 
-            if (!done_.insert(who).second) {
-                std::cerr << "[ERROR] done() called twice in same phase (phase=" << phase_idx_ << ")\n";
-                assert(false && "double done()");
+            done_ |= bit(who);
+            if (has_budget() && Clock::now() > budget_deadline_) {
+                ps.overruns++;
             }
 
-            if (done_.size() == expected_.size()) {
+            if (done_ == expected_) {
+                stats_.phasesCompleted++;
                 advance_phase_unlocked();
                 notify = true;
+            } else {
+                expire_if_overdue_unlocked();
             }
         }
 
-        // I recommend always notifying, but keep your notify flag if you want
         if (notify) {
             cv_.notify_all();
         }
     }
 
+    /// Snapshot of the degradation counters.
+    Stats stats() const {
+        std::lock_guard<std::mutex> lk(m_);
+        return stats_;
+    }
+
 private:
-    /// Rebuild expected/done sets for the current phase index.
+    static std::vector<PhaseSpec> to_specs(std::vector<Phase> phases) {
+        std::vector<PhaseSpec> specs;
+        specs.reserve(phases.size());
+        for (auto& p : phases) specs.push_back(PhaseSpec{ std::move(p) });
+        return specs;
+    }
+
+    static std::size_t index(Id id) { return static_cast<std::size_t>(id); }
+    static char name(Id id) { return static_cast<char>('A' + index(id)); }
+
+    /// Bitmask of a single participant.
+    static constexpr std::uint32_t bit(Id id) {
+        return std::uint32_t{1} << static_cast<std::uint32_t>(id);
+    }
+
+    /// True if @p who is in the current phase and has not finished it (caller holds m_).
+    bool may_run(Id who) const {
+        return (expected_ & bit(who)) != 0 && (done_ & bit(who)) == 0;
+    }
+
+    bool has_budget() const { return phases_[phase_idx_].budget.count() > 0; }
+
+    /**
+     * @brief Skip the missing participants if the phase deadline has passed.
+     *
+     * Caller must hold m_. Wakes all waiters when the phase advances.
+     *
+     * @return true if the phase was expired.
+     */
+    bool expire_if_overdue_unlocked() {
+        if (done_ == expected_ || Clock::now() < phase_deadline_) {
+            return false;
+        }
+
+        const PhaseSpec& spec = phases_[phase_idx_];
+        for (Id id : spec.ids) {
+            if ((done_ & bit(id)) == 0) stats_.participants[index(id)].skipped++;
+        }
+        if (spec.priority == Priority::Critical) {
+            std::cerr << "[WARN] FlowControl: phase " << phase_idx_
+                      << " expired, skipping late participants\n";
+        }
+
+        stats_.phasesExpired++;
+        advance_phase_unlocked();
+        cv_.notify_all();
+        return true;
+    }
+
+    /// Rebuild expected/done masks and deadlines for the current phase index.
+    /// Bitmasks instead of hash sets: no allocation on every phase change.
     void rebuild_expected_for_current_phase() {
-        expected_.clear();
-        done_.clear();
-        for (Id id : phases_[phase_idx_]) expected_.insert(id);
-        assert(!expected_.empty());
+        const PhaseSpec& spec = phases_[phase_idx_];
+        expected_ = 0;
+        done_ = 0;
+        for (Id id : spec.ids) expected_ |= bit(id);
+        assert(expected_ != 0);
+
+        const auto now = Clock::now();
+        budget_deadline_ = now + spec.budget;
+        phase_deadline_ = (spec.priority == Priority::BestEffort && has_budget())
+            ? budget_deadline_
+            : now + std::max(spec.budget, timeout_);
     }
 
     /// Advance to the next phase (caller must hold m_).
     void advance_phase_unlocked() {
         phase_idx_ = (phase_idx_ + 1) % phases_.size();
+        generation_++;
         rebuild_expected_for_current_phase();
     }
 
 private:
-    std::mutex m_;
+    mutable std::mutex m_;
     std::condition_variable cv_;
-    std::vector<Phase> phases_;
+    std::vector<PhaseSpec> phases_;
     std::chrono::milliseconds timeout_;
     size_t phase_idx_ = 0;
     bool stop_ = false;
 
-    std::unordered_set<Id, IdHash> expected_;
-    std::unordered_set<Id, IdHash> done_;
+    std::uint32_t expected_ = 0;   ///< Participants of the current phase.
+    std::uint32_t done_ = 0;       ///< Participants that finished the current phase.
+
+    std::uint64_t generation_ = 0;                        ///< Incremented on every phase change.
+    std::array<std::uint64_t, kIdCount> turn_gen_{};      ///< Generation of each participant's last turn.
+    std::array<bool, kIdCount> in_turn_{};                ///< Turn granted and not yet done().
+    Clock::time_point budget_deadline_{};                 ///< End of the phase budget.
+    Clock::time_point phase_deadline_{};                  ///< When stragglers get skipped.
+
+    Stats stats_;
 };
 
 } // namespace flow_control
@@ -13,6 +13,7 @@
 #include <thread>
 
 #include "logger.hpp"
+#include "trace.hpp"
 
 namespace runnables::internal
 {
@@ -22,11 +23,16 @@ namespace runnables::internal
 
         while (true)
         {
-            fc.wait_turn(flow_control::Id::C);
-            if (auto m = rx.try_get_latest())
+            if (fc.wait_turn(flow_control::Id::C) != flow_control::TurnStatus::Granted)
             {
-             log.info("C received cycleCounter : " +
-                     std::to_string((*m)->header().cyclecounter()));
+                continue;   // timed out: skip this cycle, the phase moves on without us
+            }
+            {
+                TRACE_SCOPE("APP_SUB_C::work");
+                if (auto m = rx.try_get_latest())
+                {
+                 log.logf(Logger::Level::INFO, "C received cycleCounter : %u", (*m)->header().cyclecounter());
+                }
             }
             fc.done(flow_control::Id::C);
         }
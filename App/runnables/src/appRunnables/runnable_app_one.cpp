@@ -14,6 +14,8 @@
 #include <thread>
 
 #include "logger.hpp"
+#include "message_pool.hpp"
+#include "trace.hpp"
 
 namespace runnables::internal
 {
@@ -22,16 +24,24 @@ namespace runnables::internal
         Logger log("APP_PUB  ", Logger::Level::INFO);
         uint16_t cnt = 0;
 
+        // Messages are recycled instead of make_shared'ed every cycle.
+        // Capacity covers the hub depth plus one message held by each receiver.
+        connection_hub::MessagePool<message_payload_one::Message> pool(16);
+
         while (true)
         {
-
-            auto msg = std::make_shared<message_payload_one::Message>();
-            // fill msg
-            auto* header = msg->mutable_header();
-            header->set_cyclecounter(cnt);
-            pub.publish(msg);
-            cnt++;
-            log.info("published cycleCounter : " + std::to_string(header->cyclecounter()));  // optional
+            {
+                TRACE_SCOPE("APP_PUB::work");
+                auto msg = pool.acquire();
+                // fill msg (reset in place: Message::Clear() would free the header)
+                auto* header = msg->mutable_header();
+                header->Clear();
+                msg->mutable_payload()->clear();
+                header->set_cyclecounter(cnt);
+                pub.publish(msg);
+                cnt++;
+                log.logf(Logger::Level::INFO, "published cycleCounter : %u", header->cyclecounter());  // optional
+            }
             std::this_thread::sleep_for(std::chrono::milliseconds(20));
 
         }
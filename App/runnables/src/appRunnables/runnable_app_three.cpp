@@ -10,26 +10,35 @@
 #include "../runnables_internal.hpp"
 
 #include <chrono>
-#include <thread>
+#include <cstdint>
 
 #include "logger.hpp"
+#include "trace.hpp"
 
 namespace runnables::internal
 {
     void runnable_app_three(Publisher /*pub*/, Receiver rx, flow_control::FlowControl& fc)
     {
         Logger log("APP_SUB_B", Logger::Level::INFO);
+        std::uint64_t seen = 0;
 
         while (true)
         {
-            fc.wait_turn(flow_control::Id::B); 
-            if (auto m = rx.try_get_latest())
+            // rx is rate-limited by the hub (see startDefault): sleep until a message is due
+            auto m = rx.wait_newer(seen, std::chrono::milliseconds(500));
+            if (!m)
             {
-             log.info("B received cycleCounter : " +
-                     std::to_string((*m)->header().cyclecounter()));
+                continue;
             }
-            fc.done(flow_control::Id::B); 
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (fc.wait_turn(flow_control::Id::B) != flow_control::TurnStatus::Granted)
+            {
+                continue;   // timed out: skip this cycle, the phase moves on without us
+            }
+            {
+                TRACE_SCOPE("APP_SUB_B::work");
+                log.logf(Logger::Level::INFO, "B received cycleCounter : %u", (*m)->header().cyclecounter());
+            }
+            fc.done(flow_control::Id::B);
         }
     }
 }
@@ -10,25 +10,32 @@
 #include "../runnables_internal.hpp"
 
 #include <chrono>
-#include <thread>
+#include <cstdint>
 
 #include "logger.hpp"
+#include "trace.hpp"
 
 namespace runnables::internal
 {
     void runnable_app_two(Publisher /*pub*/, Receiver rx, flow_control::FlowControl& fc)
     {
         Logger log("APP_SUB_A", Logger::Level::INFO);
-        uint32_t cnt = 0;
+        std::uint64_t seen = 0;
 
         while (true) {
-            fc.wait_turn(flow_control::Id::A);
-            if (auto m = rx.try_get_latest()) {
-                log.info("A received cycleCounter : " +
-                        std::to_string((*m)->header().cyclecounter()));
+            // rx is rate-limited by the hub (see startDefault): sleep until a message is due
+            auto m = rx.wait_newer(seen, std::chrono::milliseconds(500));
+            if (!m) {
+                continue;
+            }
+            if (fc.wait_turn(flow_control::Id::A) != flow_control::TurnStatus::Granted) {
+                continue;   // timed out: skip this cycle, the phase moves on without us
+            }
+            {
+                TRACE_SCOPE("APP_SUB_A::work");
+                log.logf(Logger::Level::INFO, "A received cycleCounter : %u", (*m)->header().cyclecounter());
             }
             fc.done(flow_control::Id::A);
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
 
     }
@@ -21,10 +21,17 @@ namespace runnables
         auto pub = hub->make_publisher();
         auto rx  = hub->make_receiver();
 
+        // A and B only need 10 Hz of the 50 Hz stream; the hub drops the rest
+        // at publish time, so they are not woken for messages they would skip.
+        auto rxA = hub->make_receiver(Hub::Policy::max_rate(10.0));
+        auto rxB = hub->make_receiver(Hub::Policy::max_rate(10.0));
+
+        // Best-effort budgets: a late subscriber is skipped for one cycle
+        // instead of holding back the other phases.
         flow_control::FlowControl fc(
         {
-            {flow_control::Id::A, flow_control::Id::B},
-            {flow_control::Id::C}
+            { {flow_control::Id::A, flow_control::Id::B}, std::chrono::milliseconds{150}, flow_control::Priority::BestEffort },
+            { {flow_control::Id::C},                      std::chrono::milliseconds{50},  flow_control::Priority::BestEffort }
         },
         std::chrono::milliseconds{2000}
         );
@@ -40,8 +47,8 @@ namespace runnables
 
         // Start threads. Capture hub to keep it alive.
         std::thread t1([hub, pub, rx, &fc]() mutable { runnables::internal::runnable_app_one(pub, rx, fc); });
-        std::thread t2([hub, pub, rx, &fc]() mutable { runnables::internal::runnable_app_two(pub, rx, fc); });
-        std::thread t3([hub, pub, rx, &fc]() mutable { runnables::internal::runnable_app_three(pub, rx, fc); });
+        std::thread t2([hub, pub, rxA, &fc]() mutable { runnables::internal::runnable_app_two(pub, rxA, fc); });
+        std::thread t3([hub, pub, rxB, &fc]() mutable { runnables::internal::runnable_app_three(pub, rxB, fc); });
         std::thread t4([hub, pub, rx, &fc]() mutable { runnables::internal::runnable_app_four(pub, rx, fc); });
         t1.join();
         t2.join();
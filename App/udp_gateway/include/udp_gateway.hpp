@@ -0,0 +1,288 @@
+/**
+ * @file udp_gateway.hpp
+ * @brief UDP bridge between a ConnectionHub and the network.
+ *
+ * The gateway forwards hub traffic to a remote peer (e.g. a logging PC) and
+ * republishes datagrams received from remote peers into a local hub.
+ * Datagrams are sent with sendmmsg() and received with recvmmsg() so that a
+ * whole batch costs a single system call.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "connection_hub.hpp"
+#include "message.pb.h"
+#include "message_types.hpp"
+
+namespace udp_gateway {
+
+/// Hub type bridged by the gateway.
+using Hub = connection_hub::ConnectionHub<message_payload_one::Message>;
+
+/**
+ * @brief Wire header preceding every payload in a gateway datagram.
+ *
+ * Wraps a @ref message_types::SignalHeader with a magic value, the payload
+ * length and a per-sender sequence number used for loss accounting.
+ *
+ * All fields are encoded little-endian on the wire.
+ */
+struct FrameHeader
+{
+    /// Frame identifier, must equal @ref kFrameMagic.
+    std::uint16_t magic;
+
+    /// Number of payload bytes following the header.
+    std::uint16_t payloadSize;
+
+    /// Per-sender sequence number, incremented for every frame. Wraps on overflow.
+    std::uint32_t sequence;
+
+    /// Signal metadata of the forwarded message.
+    message_types::SignalHeader signal;
+};
+
+/// Magic value identifying gateway frames ("HG").
+inline constexpr std::uint16_t kFrameMagic = 0x4748;
+
+/// Encoded size of a @ref FrameHeader.
+inline constexpr std::size_t kFrameHeaderSize = 16;
+
+static_assert(sizeof(FrameHeader) == kFrameHeaderSize, "FrameHeader size mismatch");
+
+/**
+ * @brief IPv4 endpoint description.
+ */
+struct Endpoint
+{
+    std::string   address = "127.0.0.1";  ///< Dotted-quad IPv4 address.
+    std::uint16_t port    = 0;            ///< UDP port (0 = ephemeral when binding).
+};
+
+/**
+ * @brief Tuning parameters shared by sender and receiver.
+ */
+struct GatewayConfig
+{
+    /// Maximum number of datagrams per sendmmsg()/recvmmsg() call.
+    std::size_t batchSize = 32;
+
+    /// Largest payload carried in one datagram (bytes).
+    std::size_t maxPayload = 1400;
+
+    /// Longest time a queued frame may wait before the batch is flushed.
+    std::chrono::milliseconds flushInterval{ 20 };
+
+    /// Sleep between polls of the hub receiver in UdpSender::run().
+    std::chrono::milliseconds pollInterval{ 1 };
+};
+
+/**
+ * @brief Counters kept by a UdpSender.
+ */
+struct SenderStats
+{
+    std::uint64_t sent      = 0;  ///< Frames handed to the kernel.
+    std::uint64_t dropped   = 0;  ///< Frames discarded (too large or send failure).
+    std::uint64_t batches   = 0;  ///< Number of sendmmsg() calls issued.
+    std::uint32_t nextSequence = 0;  ///< Sequence number of the next frame.
+};
+
+/**
+ * @brief Per-peer counters kept by a UdpReceiver.
+ *
+ * Only frames newer than lastSequence are published; reordered, duplicate
+ * and stale frames are counted and dropped, so the hub never goes back in
+ * time.
+ */
+struct PeerStats
+{
+    std::string   peer;              ///< "ip:port" of the remote sender.
+    std::uint64_t received  = 0;     ///< Valid frames received.
+    std::uint64_t lost      = 0;     ///< Frames missing from the sequence.
+    std::uint64_t reordered = 0;     ///< Frames arriving late, after a newer sequence number.
+    std::uint64_t duplicates = 0;    ///< Frames whose sequence number was already received.
+    std::uint64_t stale     = 0;     ///< Late frames too old to tell reordered from duplicate.
+    std::uint64_t restarts  = 0;     ///< Backward jumps taken as a restarted sender.
+    std::uint64_t dropped   = 0;     ///< Frames not published (reordered + duplicates + stale).
+    std::uint32_t lastSequence = 0;  ///< Highest sequence number seen in the current stream.
+};
+
+/**
+ * @brief Encode @p header into @p out (kFrameHeaderSize bytes, little-endian).
+ */
+void encode_header(const FrameHeader& header, std::uint8_t* out);
+
+/**
+ * @brief Decode a frame header from @p in (kFrameHeaderSize bytes, little-endian).
+ */
+FrameHeader decode_header(const std::uint8_t* in);
+
+/**
+ * @class UdpSender
+ * @brief Batches hub messages into datagrams and sends them with sendmmsg().
+ *
+ * UdpSender is not thread-safe; it is meant to be driven by a single
+ * gateway thread, typically through run().
+ */
+class UdpSender
+{
+public:
+    /**
+     * @brief Open a UDP socket connected to @p destination.
+     *
+     * @throws std::system_error If the socket cannot be created or connected.
+     * @throws std::invalid_argument If the address is not a valid IPv4 address.
+     */
+    explicit UdpSender(const Endpoint& destination, const GatewayConfig& cfg = {});
+    ~UdpSender();
+
+    /// Non-copyable.
+    UdpSender(const UdpSender&) = delete;
+    UdpSender& operator=(const UdpSender&) = delete;
+
+    /**
+     * @brief Queue @p msg for the next batch, flushing first if the batch is full.
+     *
+     * @return false if the payload exceeds GatewayConfig::maxPayload.
+     */
+    bool enqueue(const message_payload_one::Message& msg);
+
+    /// Number of frames waiting for the next flush().
+    std::size_t pending() const { return pending_; }
+
+    /**
+     * @brief Send all queued frames using as few sendmmsg() calls as possible.
+     *
+     * @return Number of frames accepted by the kernel.
+     */
+    std::size_t flush();
+
+    /// Snapshot of the sender counters. Safe to call from any thread.
+    SenderStats stats() const;
+
+    /**
+     * @brief Queue the latest message of @p rx if it was published after @p lastSeen.
+     *
+     * Uses the hub's publish count, not the message address, so a recycled
+     * message object (MessagePool, allocator reuse) is still forwarded.
+     *
+     * @param lastSeen In/out publish count, 0 initially (see Hub::Receiver::try_get_newer).
+     * @return true if a frame was queued.
+     */
+    bool forward(const Hub::Receiver& rx, std::uint64_t& lastSeen);
+
+    /**
+     * @brief Gateway loop: forward() every new message seen on @p rx until @p running is false.
+     *
+     * The hub only exposes its latest value, so a message is forwarded once
+     * when it first becomes visible; messages overwritten between two polls
+     * are not sent. Pending frames are flushed when the batch is full or
+     * after GatewayConfig::flushInterval.
+     */
+    void run(Hub::Receiver rx, const std::atomic<bool>& running);
+
+private:
+    int           fd_ = -1;
+    GatewayConfig cfg_;
+
+    std::vector<std::uint8_t> storage_;  ///< batchSize frames of header + maxPayload.
+    std::vector<mmsghdr>      msgs_;
+    std::vector<iovec>        iovs_;
+    std::size_t               pending_ = 0;
+
+    mutable std::mutex stats_m_;
+    SenderStats        stats_;
+};
+
+/**
+ * @class UdpReceiver
+ * @brief Receives gateway datagrams with recvmmsg() and republishes them into a hub.
+ *
+ * A frame is published only if its sequence number is newer than the last
+ * one published for its sender (see PeerStats). A jump back to a sequence
+ * number below kRecentWindow, or by more than kStaleWindow, is taken as a
+ * restarted sender and starts a new stream.
+ *
+ * All receive buffers are allocated once at construction. Like UdpSender,
+ * the receive path is meant to be driven by a single thread; peer_stats()
+ * may be called concurrently.
+ */
+class UdpReceiver
+{
+public:
+    /**
+     * @brief Open a UDP socket bound to @p bindTo.
+     *
+     * @throws std::system_error If the socket cannot be created or bound.
+     * @throws std::invalid_argument If the address is not a valid IPv4 address.
+     */
+    explicit UdpReceiver(const Endpoint& bindTo, const GatewayConfig& cfg = {});
+    ~UdpReceiver();
+
+    /// Non-copyable.
+    UdpReceiver(const UdpReceiver&) = delete;
+    UdpReceiver& operator=(const UdpReceiver&) = delete;
+
+    /// Port the socket is bound to (resolved when binding to port 0).
+    std::uint16_t port() const { return port_; }
+
+    /**
+     * @brief Wait up to @p timeout for datagrams and publish every valid frame.
+     *
+     * @return Number of messages published into @p pub.
+     */
+    std::size_t poll(Hub::Publisher& pub, std::chrono::milliseconds timeout);
+
+    /// Snapshot of the per-peer counters.
+    std::vector<PeerStats> peer_stats() const;
+
+    /// Number of datagrams rejected as malformed.
+    std::uint64_t malformed() const;
+
+    /// Gateway loop: call poll() until @p running is false.
+    void run(Hub::Publisher pub, const std::atomic<bool>& running);
+
+private:
+    /// Sequence numbers behind the newest one that are checked for duplicates.
+    static constexpr std::int32_t kRecentWindow = 64;
+
+    /// Older frames up to this far back are stale; further back, the sender restarted.
+    static constexpr std::int32_t kStaleWindow = 1024;
+
+    /// Counters plus a bitmap of the last kRecentWindow sequence numbers received.
+    struct Peer
+    {
+        PeerStats     stats;
+        std::uint64_t recent = 0;   ///< Bit i: lastSequence - i was received.
+    };
+
+    /// Update the counters of the sender; true if @p sequence is the newest of its stream.
+    bool account(const sockaddr_in& from, std::uint32_t sequence);
+
+    int           fd_ = -1;
+    std::uint16_t port_ = 0;
+    GatewayConfig cfg_;
+
+    std::vector<std::uint8_t> storage_;
+    std::vector<mmsghdr>      msgs_;
+    std::vector<iovec>        iovs_;
+    std::vector<sockaddr_in>  addrs_;
+
+    mutable std::mutex                           stats_m_;
+    std::unordered_map<std::uint64_t, Peer>      peers_;
+    std::uint64_t                                malformed_ = 0;
+};
+
+} // namespace udp_gateway
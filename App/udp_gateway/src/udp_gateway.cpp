@@ -0,0 +1,437 @@
+/**
+ * @file udp_gateway.cpp
+ * @brief UDP bridge between a ConnectionHub and the network.
+ */
+#include "udp_gateway.hpp"
+#include "logger.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <poll.h>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+namespace udp_gateway {
+
+namespace {
+
+void put16(std::uint8_t* p, std::uint16_t v)
+{
+    p[0] = static_cast<std::uint8_t>(v);
+    p[1] = static_cast<std::uint8_t>(v >> 8);
+}
+
+void put32(std::uint8_t* p, std::uint32_t v)
+{
+    put16(p, static_cast<std::uint16_t>(v));
+    put16(p + 2, static_cast<std::uint16_t>(v >> 16));
+}
+
+std::uint16_t get16(const std::uint8_t* p)
+{
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::uint32_t get32(const std::uint8_t* p)
+{
+    return static_cast<std::uint32_t>(get16(p)) | (static_cast<std::uint32_t>(get16(p + 2)) << 16);
+}
+
+sockaddr_in to_sockaddr(const Endpoint& ep)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(ep.port);
+    if (inet_pton(AF_INET, ep.address.c_str(), &addr.sin_addr) != 1)
+    {
+        throw std::invalid_argument("udp_gateway: invalid IPv4 address '" + ep.address + "'");
+    }
+    return addr;
+}
+
+int open_socket()
+{
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "udp_gateway: socket()");
+    }
+    return fd;
+}
+
+// Point every mmsghdr at its own preallocated frame slot.
+void wire_batch(std::vector<std::uint8_t>& storage, std::vector<mmsghdr>& msgs,
+                std::vector<iovec>& iovs, std::size_t batch, std::size_t frameSize)
+{
+    storage.assign(batch * frameSize, 0);
+    msgs.assign(batch, mmsghdr{});
+    iovs.assign(batch, iovec{});
+    for (std::size_t i = 0; i < batch; ++i)
+    {
+        iovs[i].iov_base = storage.data() + i * frameSize;
+        iovs[i].iov_len  = frameSize;
+        msgs[i].msg_hdr.msg_iov    = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+} // namespace
+
+// Serialize field by field so the wire format does not depend on host endianness.
+void encode_header(const FrameHeader& header, std::uint8_t* out)
+{
+    put16(out + 0, header.magic);
+    put16(out + 2, header.payloadSize);
+    put32(out + 4, header.sequence);
+    out[8]  = header.signal.version;
+    out[9]  = header.signal.eSigStatus;
+    out[10] = header.signal.eSensorSource;
+    out[11] = header.signal.reserved0;
+    put16(out + 12, header.signal.cycleCounter);
+    put16(out + 14, header.signal.measurementCounter);
+}
+
+FrameHeader decode_header(const std::uint8_t* in)
+{
+    FrameHeader h{};
+    h.magic       = get16(in + 0);
+    h.payloadSize = get16(in + 2);
+    h.sequence    = get32(in + 4);
+    h.signal.version       = in[8];
+    h.signal.eSigStatus    = in[9];
+    h.signal.eSensorSource = in[10];
+    h.signal.reserved0     = in[11];
+    h.signal.cycleCounter       = get16(in + 12);
+    h.signal.measurementCounter = get16(in + 14);
+    return h;
+}
+
+// ---------------------------------------------------------------------------
+// UdpSender
+// ---------------------------------------------------------------------------
+
+UdpSender::UdpSender(const Endpoint& destination, const GatewayConfig& cfg)
+    : cfg_(cfg)
+{
+    if (cfg_.batchSize == 0 || cfg_.maxPayload > 0xFFFF)
+    {
+        throw std::invalid_argument("udp_gateway: batchSize must be > 0 and maxPayload <= 65535");
+    }
+
+    const sockaddr_in addr = to_sockaddr(destination);
+    fd_ = open_socket();
+    if (::connect(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        const int err = errno;
+        ::close(fd_);
+        throw std::system_error(err, std::generic_category(), "udp_gateway: connect()");
+    }
+
+    wire_batch(storage_, msgs_, iovs_, cfg_.batchSize, kFrameHeaderSize + cfg_.maxPayload);
+}
+
+UdpSender::~UdpSender()
+{
+    if (fd_ >= 0)
+    {
+        flush();
+        ::close(fd_);
+    }
+}
+
+bool UdpSender::enqueue(const message_payload_one::Message& msg)
+{
+    const std::string& payload = msg.payload();
+    if (payload.size() > cfg_.maxPayload)
+    {
+        std::lock_guard<std::mutex> lk(stats_m_);
+        stats_.dropped++;
+        return false;
+    }
+
+    if (pending_ == cfg_.batchSize)
+    {
+        flush();
+    }
+
+    const auto& src = msg.header();
+    FrameHeader h{};
+    h.magic       = kFrameMagic;
+    h.payloadSize = static_cast<std::uint16_t>(payload.size());
+    h.signal.version            = static_cast<std::uint8_t>(src.version());
+    h.signal.eSigStatus         = static_cast<std::uint8_t>(src.esigstatus());
+    h.signal.eSensorSource      = static_cast<std::uint8_t>(src.esensorsource());
+    h.signal.reserved0          = static_cast<std::uint8_t>(src.reserved0());
+    h.signal.cycleCounter       = static_cast<std::uint16_t>(src.cyclecounter());
+    h.signal.measurementCounter = static_cast<std::uint16_t>(src.measurementcounter());
+    {
+        std::lock_guard<std::mutex> lk(stats_m_);
+        h.sequence = stats_.nextSequence++;
+    }
+
+    auto* frame = static_cast<std::uint8_t*>(iovs_[pending_].iov_base);
+    encode_header(h, frame);
+    std::memcpy(frame + kFrameHeaderSize, payload.data(), payload.size());
+    iovs_[pending_].iov_len = kFrameHeaderSize + payload.size();
+    pending_++;
+    return true;
+}
+
+std::size_t UdpSender::flush()
+{
+    std::size_t sent = 0;
+    std::size_t batches = 0;
+
+    while (sent < pending_)
+    {
+        const int rc = ::sendmmsg(fd_, msgs_.data() + sent,
+                                  static_cast<unsigned int>(pending_ - sent), 0);
+        batches++;
+        if (rc < 0)
+        {
+            if (errno == EINTR) continue;
+            // ECONNREFUSED etc. on a connected UDP socket: drop the rest of the batch.
+            break;
+        }
+        sent += static_cast<std::size_t>(rc);
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(stats_m_);
+        stats_.sent    += sent;
+        stats_.dropped += pending_ - sent;
+        stats_.batches += batches;
+    }
+    pending_ = 0;
+    return sent;
+}
+
+SenderStats UdpSender::stats() const
+{
+    std::lock_guard<std::mutex> lk(stats_m_);
+    return stats_;
+}
+
+bool UdpSender::forward(const Hub::Receiver& rx, std::uint64_t& lastSeen)
+{
+    const auto m = rx.try_get_newer(lastSeen);
+    if (!m || !*m) return false;
+
+    if (!enqueue(**m))
+    {
+        Logger log("UDP_TX   ", Logger::Level::WARN);
+        log.warn("dropped oversized payload (" + std::to_string((*m)->payload().size()) + " bytes)");
+        return false;
+    }
+    return true;
+}
+
+void UdpSender::run(Hub::Receiver rx, const std::atomic<bool>& running)
+{
+    std::uint64_t lastSeen = 0;
+    auto batchStart = std::chrono::steady_clock::now();
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        const bool first = pending_ == 0;
+        if (forward(rx, lastSeen) && first) batchStart = std::chrono::steady_clock::now();
+
+        if (pending_ != 0 &&
+            (pending_ >= cfg_.batchSize ||
+             std::chrono::steady_clock::now() - batchStart >= cfg_.flushInterval))
+        {
+            flush();
+        }
+
+        std::this_thread::sleep_for(cfg_.pollInterval);
+    }
+    flush();
+}
+
+// ---------------------------------------------------------------------------
+// UdpReceiver
+// ---------------------------------------------------------------------------
+
+UdpReceiver::UdpReceiver(const Endpoint& bindTo, const GatewayConfig& cfg)
+    : cfg_(cfg)
+{
+    if (cfg_.batchSize == 0 || cfg_.maxPayload > 0xFFFF)
+    {
+        throw std::invalid_argument("udp_gateway: batchSize must be > 0 and maxPayload <= 65535");
+    }
+
+    const sockaddr_in addr = to_sockaddr(bindTo);
+    fd_ = open_socket();
+    if (::bind(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        const int err = errno;
+        ::close(fd_);
+        throw std::system_error(err, std::generic_category(), "udp_gateway: bind()");
+    }
+
+    sockaddr_in bound{};
+    socklen_t len = sizeof(bound);
+    ::getsockname(fd_, reinterpret_cast<sockaddr*>(&bound), &len);
+    port_ = ntohs(bound.sin_port);
+
+    wire_batch(storage_, msgs_, iovs_, cfg_.batchSize, kFrameHeaderSize + cfg_.maxPayload);
+    addrs_.assign(cfg_.batchSize, sockaddr_in{});
+    for (std::size_t i = 0; i < cfg_.batchSize; ++i)
+    {
+        msgs_[i].msg_hdr.msg_name = &addrs_[i];
+    }
+}
+
+UdpReceiver::~UdpReceiver()
+{
+    if (fd_ >= 0) ::close(fd_);
+}
+
+std::size_t UdpReceiver::poll(Hub::Publisher& pub, std::chrono::milliseconds timeout)
+{
+    pollfd pfd{ fd_, POLLIN, 0 };
+    if (::poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0)
+    {
+        return 0;
+    }
+
+    // recvmmsg() overwrites the lengths, so restore them before each call.
+    for (std::size_t i = 0; i < cfg_.batchSize; ++i)
+    {
+        iovs_[i].iov_len = kFrameHeaderSize + cfg_.maxPayload;
+        msgs_[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    }
+
+    const int rc = ::recvmmsg(fd_, msgs_.data(), static_cast<unsigned int>(cfg_.batchSize),
+                              MSG_DONTWAIT, nullptr);
+    if (rc <= 0)
+    {
+        return 0;
+    }
+
+    std::size_t published = 0;
+    for (int i = 0; i < rc; ++i)
+    {
+        const auto* frame = static_cast<const std::uint8_t*>(iovs_[i].iov_base);
+        const std::size_t len = msgs_[i].msg_len;
+
+        const FrameHeader h = (len >= kFrameHeaderSize) ? decode_header(frame) : FrameHeader{};
+        if (len < kFrameHeaderSize || h.magic != kFrameMagic ||
+            kFrameHeaderSize + h.payloadSize != len)
+        {
+            std::lock_guard<std::mutex> lk(stats_m_);
+            malformed_++;
+            continue;
+        }
+
+        if (!account(addrs_[i], h.sequence))
+        {
+            continue;   // late or repeated: publishing it would replace newer data
+        }
+
+        auto msg = std::make_shared<message_payload_one::Message>();
+        auto* header = msg->mutable_header();
+        header->set_version(h.signal.version);
+        header->set_esigstatus(static_cast<message_payload_one::SigStatus>(h.signal.eSigStatus));
+        header->set_esensorsource(static_cast<message_payload_one::SensorSource>(h.signal.eSensorSource));
+        header->set_reserved0(h.signal.reserved0);
+        header->set_cyclecounter(h.signal.cycleCounter);
+        header->set_measurementcounter(h.signal.measurementCounter);
+        msg->set_payload(frame + kFrameHeaderSize, h.payloadSize);
+
+        pub.publish(std::move(msg));
+        published++;
+    }
+    return published;
+}
+
+// Track sequence numbers per sender; signed distance handles wrap-around.
+bool UdpReceiver::account(const sockaddr_in& from, std::uint32_t sequence)
+{
+    const std::uint64_t key = (static_cast<std::uint64_t>(from.sin_addr.s_addr) << 16) | from.sin_port;
+
+    std::lock_guard<std::mutex> lk(stats_m_);
+    auto [it, inserted] = peers_.try_emplace(key);
+    Peer& peer = it->second;
+    PeerStats& p = peer.stats;
+
+    if (inserted)
+    {
+        char ip[INET_ADDRSTRLEN] = {};
+        ::inet_ntop(AF_INET, &from.sin_addr, ip, sizeof(ip));
+        p.peer = std::string(ip) + ":" + std::to_string(ntohs(from.sin_port));
+        p.received = 1;
+        p.lastSequence = sequence;
+        peer.recent = 1;
+        return true;
+    }
+
+    p.received++;
+    const auto distance = static_cast<std::int32_t>(sequence - p.lastSequence);
+    if (distance > 0)
+    {
+        p.lost += static_cast<std::uint64_t>(distance - 1);
+        p.lastSequence = sequence;
+        peer.recent = (distance < kRecentWindow) ? (peer.recent << distance) | 1 : 1;
+        return true;
+    }
+
+    const std::int64_t age = -static_cast<std::int64_t>(distance);
+    if (age >= kRecentWindow && (sequence < static_cast<std::uint32_t>(kRecentWindow) || age > kStaleWindow))
+    {
+        // The sender restarted (its sequence starts over): follow the new stream.
+        p.restarts++;
+        p.lastSequence = sequence;
+        peer.recent = 1;
+        return true;
+    }
+
+    p.dropped++;
+    if (age >= kRecentWindow)
+    {
+        p.stale++;
+        return false;
+    }
+
+    const std::uint64_t bit = std::uint64_t{1} << age;
+    if (peer.recent & bit)
+    {
+        p.duplicates++;
+        return false;
+    }
+
+    // Late arrival fills a gap that was already counted as lost.
+    peer.recent |= bit;
+    p.reordered++;
+    if (p.lost > 0) p.lost--;
+    return false;
+}
+
+std::vector<PeerStats> UdpReceiver::peer_stats() const
+{
+    std::lock_guard<std::mutex> lk(stats_m_);
+    std::vector<PeerStats> out;
+    out.reserve(peers_.size());
+    for (const auto& kv : peers_) out.push_back(kv.second.stats);
+    return out;
+}
+
+std::uint64_t UdpReceiver::malformed() const
+{
+    std::lock_guard<std::mutex> lk(stats_m_);
+    return malformed_;
+}
+
+void UdpReceiver::run(Hub::Publisher pub, const std::atomic<bool>& running)
+{
+    while (running.load(std::memory_order_relaxed))
+    {
+        poll(pub, cfg_.flushInterval);
+    }
+}
+
+} // namespace udp_gateway
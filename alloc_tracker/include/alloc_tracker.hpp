@@ -0,0 +1,88 @@
+/**
+ * @file alloc_tracker.hpp
+ * @brief Counting hooks for the global allocator.
+ *
+ * When built with PROJECT_ALLOC_TRACKING=1 the module replaces the global
+ * operator new/delete and counts every allocation per thread and per call
+ * site. Runnables use it to verify that the steady state never touches the
+ * system allocator. With tracking disabled every query returns zeros.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#ifndef PROJECT_ALLOC_TRACKING
+#define PROJECT_ALLOC_TRACKING 0
+#endif
+
+namespace alloc_tracker {
+
+/// True if the counting operator new/delete are linked in.
+inline constexpr bool kEnabled = PROJECT_ALLOC_TRACKING != 0;
+
+/**
+ * @brief Allocation counters.
+ */
+struct Counters
+{
+    std::uint64_t allocs = 0;  ///< Calls to operator new (all variants).
+    std::uint64_t frees  = 0;  ///< Calls to operator delete with a non-null pointer.
+    std::uint64_t bytes  = 0;  ///< Bytes requested from operator new.
+};
+
+/// Counter difference @p a - @p b.
+inline Counters operator-(const Counters& a, const Counters& b)
+{
+    return Counters{ a.allocs - b.allocs, a.frees - b.frees, a.bytes - b.bytes };
+}
+
+/**
+ * @brief Counters of one thread that allocated at least once.
+ */
+struct ThreadReport
+{
+    int      tid = 0;     ///< Kernel thread id.
+    char     name[16] {}; ///< Thread name when the thread first allocated.
+    Counters counters;
+};
+
+/**
+ * @brief Counters of one allocation call site.
+ */
+struct SiteReport
+{
+    const void*   caller = nullptr;  ///< Return address inside the allocating function.
+    std::uint64_t allocs = 0;
+    std::uint64_t bytes  = 0;
+};
+
+/// Counters of the calling thread.
+Counters thread_counters();
+
+/// Counters summed over all threads.
+Counters process_counters();
+
+/// Per-thread counters of every thread seen so far.
+std::vector<ThreadReport> per_thread();
+
+/// The @p n call sites with the most allocations since the last reset_sites().
+std::vector<SiteReport> top_sites(std::size_t n);
+
+/// Forget per-site counters (e.g. when the steady state begins).
+void reset_sites();
+
+/// Print per-thread counters and the top @p sites call sites (symbolized if possible).
+void report(std::ostream& os, std::size_t sites = 10);
+
+/**
+ * @brief Print report() to stderr every time signal @p sig is received.
+ *
+ * Same contract as trace::dump_on_signal(): call before other threads exist,
+ * and block every signal handled by a helper before starting the first one.
+ */
+void report_on_signal(int sig);
+
+} // namespace alloc_tracker
@@ -0,0 +1,241 @@
+/**
+ * @file alloc_tracker.cpp
+ * @brief Allocation counters, call-site table and reporting.
+ *
+ * Everything reachable from operator new lives in fixed-size static tables,
+ * so recording an allocation never allocates.
+ */
+#include "alloc_tracker.hpp"
+#include "alloc_tracker_internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <ostream>
+#include <pthread.h>
+#include <thread>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#if PROJECT_ALLOC_TRACKING
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+namespace alloc_tracker {
+
+namespace {
+
+constexpr std::size_t kMaxThreads = 256;   ///< Last slot is shared by overflowing threads.
+constexpr std::size_t kMaxSites   = 4096;  ///< Power of two.
+constexpr std::size_t kMaxProbe   = 64;
+
+struct ThreadSlot
+{
+    std::atomic<std::uint64_t> allocs{0};
+    std::atomic<std::uint64_t> frees{0};
+    std::atomic<std::uint64_t> bytes{0};
+    int  tid = 0;
+    char name[16] {};
+};
+
+struct Site
+{
+    std::atomic<std::uintptr_t> caller{0};
+    std::atomic<std::uint64_t>  allocs{0};
+    std::atomic<std::uint64_t>  bytes{0};
+};
+
+ThreadSlot                  g_threads[kMaxThreads];
+std::atomic<std::size_t>    g_threadCount{0};
+Site                        g_sites[kMaxSites];
+Site                        g_otherSites;   ///< Sites that did not fit the table.
+
+thread_local ThreadSlot*    t_slot = nullptr;
+
+// Claim a slot for the calling thread; uses no heap.
+ThreadSlot& this_thread_slot()
+{
+    if (t_slot == nullptr)
+    {
+        const std::size_t idx = g_threadCount.fetch_add(1, std::memory_order_relaxed);
+        ThreadSlot& s = g_threads[std::min(idx, kMaxThreads - 1)];
+        if (idx < kMaxThreads)
+        {
+            s.tid = static_cast<int>(::syscall(SYS_gettid));
+            pthread_getname_np(pthread_self(), s.name, sizeof(s.name));
+        }
+        t_slot = &s;
+    }
+    return *t_slot;
+}
+
+Site& site_for(std::uintptr_t caller)
+{
+    std::size_t h = (caller >> 4) * 0x9E3779B97F4A7C15ull;
+    for (std::size_t probe = 0; probe < kMaxProbe; ++probe)
+    {
+        Site& s = g_sites[(h + probe) & (kMaxSites - 1)];
+        std::uintptr_t cur = s.caller.load(std::memory_order_relaxed);
+        if (cur == caller) return s;
+        if (cur == 0 && s.caller.compare_exchange_strong(cur, caller, std::memory_order_relaxed)) return s;
+        if (cur == caller) return s;
+    }
+    return g_otherSites;
+}
+
+Counters load(const ThreadSlot& s)
+{
+    return Counters{ s.allocs.load(std::memory_order_relaxed),
+                     s.frees.load(std::memory_order_relaxed),
+                     s.bytes.load(std::memory_order_relaxed) };
+}
+
+std::size_t used_slots()
+{
+    return std::min(g_threadCount.load(std::memory_order_relaxed), kMaxThreads);
+}
+
+void print_site(std::ostream& os, const SiteReport& s)
+{
+    os << "  " << s.caller;
+#if PROJECT_ALLOC_TRACKING
+    Dl_info info{};
+    if (s.caller != nullptr && dladdr(s.caller, &info) != 0 && info.dli_sname != nullptr)
+    {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        os << " " << (status == 0 && demangled ? demangled : info.dli_sname)
+           << "+0x" << std::hex
+           << (reinterpret_cast<std::uintptr_t>(s.caller) - reinterpret_cast<std::uintptr_t>(info.dli_saddr))
+           << std::dec;
+        std::free(demangled);
+    }
+#endif
+    os << "  allocs " << s.allocs << "  bytes " << s.bytes << "\n";
+}
+
+} // namespace
+
+void detail::record_alloc(std::size_t size, const void* caller)
+{
+    ThreadSlot& t = this_thread_slot();
+    t.allocs.fetch_add(1, std::memory_order_relaxed);
+    t.bytes.fetch_add(size, std::memory_order_relaxed);
+
+    Site& s = site_for(reinterpret_cast<std::uintptr_t>(caller));
+    s.allocs.fetch_add(1, std::memory_order_relaxed);
+    s.bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void detail::record_free()
+{
+    this_thread_slot().frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+Counters thread_counters()
+{
+    return t_slot ? load(*t_slot) : Counters{};
+}
+
+Counters process_counters()
+{
+    Counters c;
+    for (std::size_t i = 0; i < used_slots(); ++i)
+    {
+        const Counters t = load(g_threads[i]);
+        c.allocs += t.allocs;
+        c.frees  += t.frees;
+        c.bytes  += t.bytes;
+    }
+    return c;
+}
+
+std::vector<ThreadReport> per_thread()
+{
+    std::vector<ThreadReport> out(used_slots());
+    for (std::size_t i = 0; i < out.size(); ++i)
+    {
+        out[i].tid = g_threads[i].tid;
+        std::memcpy(out[i].name, g_threads[i].name, sizeof(out[i].name));
+        out[i].counters = load(g_threads[i]);
+    }
+    return out;
+}
+
+std::vector<SiteReport> top_sites(std::size_t n)
+{
+    std::vector<SiteReport> out;
+    for (const Site& s : g_sites)
+    {
+        const std::uint64_t allocs = s.allocs.load(std::memory_order_relaxed);
+        if (allocs == 0) continue;
+        out.push_back({ reinterpret_cast<const void*>(s.caller.load(std::memory_order_relaxed)),
+                        allocs, s.bytes.load(std::memory_order_relaxed) });
+    }
+    if (const std::uint64_t other = g_otherSites.allocs.load(std::memory_order_relaxed))
+    {
+        out.push_back({ nullptr, other, g_otherSites.bytes.load(std::memory_order_relaxed) });
+    }
+
+    std::sort(out.begin(), out.end(),
+              [](const SiteReport& a, const SiteReport& b) { return a.allocs > b.allocs; });
+    if (out.size() > n) out.resize(n);
+    return out;
+}
+
+// Keep the caller keys so concurrent inserts never land on a recycled slot.
+void reset_sites()
+{
+    for (Site& s : g_sites)
+    {
+        s.allocs.store(0, std::memory_order_relaxed);
+        s.bytes.store(0, std::memory_order_relaxed);
+    }
+    g_otherSites.allocs.store(0, std::memory_order_relaxed);
+    g_otherSites.bytes.store(0, std::memory_order_relaxed);
+}
+
+void report(std::ostream& os, std::size_t sites)
+{
+    if (!kEnabled)
+    {
+        os << "[alloc_tracker] disabled (configure with -DPROJECT_ALLOC_TRACKING=ON)\n";
+        return;
+    }
+
+    const Counters total = process_counters();
+    os << "[alloc_tracker] total allocs " << total.allocs << "  frees " << total.frees
+       << "  bytes " << total.bytes << "\n";
+    for (const ThreadReport& t : per_thread())
+    {
+        os << "  tid " << t.tid << " '" << t.name << "'  allocs " << t.counters.allocs
+           << "  frees " << t.counters.frees << "  bytes " << t.counters.bytes << "\n";
+    }
+    os << "[alloc_tracker] top call sites\n";
+    for (const SiteReport& s : top_sites(sites)) print_site(os, s);
+}
+
+void report_on_signal(int sig)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, sig);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+    std::thread([set] {
+        for (;;)
+        {
+            int got = 0;
+            if (sigwait(&set, &got) == 0)
+            {
+                report(std::cerr);
+            }
+        }
+    }).detach();
+}
+
+} // namespace alloc_tracker
@@ -0,0 +1,17 @@
+/**
+ * @file alloc_tracker_internal.hpp
+ * @brief Recording entry points used by the replacement operator new/delete.
+ */
+#pragma once
+
+#include <cstddef>
+
+namespace alloc_tracker::detail {
+
+/// Count one allocation of @p size bytes made from @p caller. Never allocates.
+void record_alloc(std::size_t size, const void* caller);
+
+/// Count one deallocation. Never allocates.
+void record_free();
+
+} // namespace alloc_tracker::detail
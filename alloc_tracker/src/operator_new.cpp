@@ -0,0 +1,75 @@
+/**
+ * @file operator_new.cpp
+ * @brief Counting replacements of the global operator new/delete.
+ *
+ * Only compiled when PROJECT_ALLOC_TRACKING is ON. Memory still comes from
+ * malloc(); the hooks just record size, thread and call site first.
+ */
+#include "alloc_tracker_internal.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Always inlined so __builtin_return_address(0) in the caller is the allocation site.
+[[gnu::always_inline]] inline void* tracked_alloc(std::size_t size, std::size_t align,
+                                                  const void* caller, bool nothrow)
+{
+    alloc_tracker::detail::record_alloc(size, caller);
+
+    if (size == 0) size = 1;
+    void* p = nullptr;
+    if (align <= alignof(std::max_align_t))
+    {
+        p = std::malloc(size);
+    }
+    else if (posix_memalign(&p, align, size) != 0)
+    {
+        p = nullptr;
+    }
+
+    if (p == nullptr && !nothrow) throw std::bad_alloc();
+    return p;
+}
+
+[[gnu::always_inline]] inline void tracked_free(void* p)
+{
+    if (p == nullptr) return;
+    alloc_tracker::detail::record_free();
+    std::free(p);
+}
+
+constexpr std::size_t kDefaultAlign = alignof(std::max_align_t);
+
+} // namespace
+
+void* operator new(std::size_t n)   { return tracked_alloc(n, kDefaultAlign, __builtin_return_address(0), false); }
+void* operator new[](std::size_t n) { return tracked_alloc(n, kDefaultAlign, __builtin_return_address(0), false); }
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept
+{ return tracked_alloc(n, kDefaultAlign, __builtin_return_address(0), true); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept
+{ return tracked_alloc(n, kDefaultAlign, __builtin_return_address(0), true); }
+
+void* operator new(std::size_t n, std::align_val_t a)
+{ return tracked_alloc(n, static_cast<std::size_t>(a), __builtin_return_address(0), false); }
+void* operator new[](std::size_t n, std::align_val_t a)
+{ return tracked_alloc(n, static_cast<std::size_t>(a), __builtin_return_address(0), false); }
+void* operator new(std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept
+{ return tracked_alloc(n, static_cast<std::size_t>(a), __builtin_return_address(0), true); }
+void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept
+{ return tracked_alloc(n, static_cast<std::size_t>(a), __builtin_return_address(0), true); }
+
+void operator delete(void* p) noexcept                                     { tracked_free(p); }
+void operator delete[](void* p) noexcept                                   { tracked_free(p); }
+void operator delete(void* p, std::size_t) noexcept                        { tracked_free(p); }
+void operator delete[](void* p, std::size_t) noexcept                      { tracked_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept              { tracked_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept            { tracked_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept                   { tracked_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept                 { tracked_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept      { tracked_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept    { tracked_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept   { tracked_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(p); }
@@ -48,8 +48,21 @@ case "$TARGET" in
     echo "Run locally:"
     echo "  ./build-host/project_beagleplay"
     ;;
+  tsan)
+    log "Configure host (ThreadSanitizer)"
+    cmake -S . -B build-tsan "${GENERATOR[@]}" \
+      -DPROJECT_ENABLE_TSAN=ON
+
+    log "Build host (ThreadSanitizer)"
+    cmake --build build-tsan -v
+
+    echo
+    echo "Run the stress harness under TSan:"
+    echo "  ./build-tsan/tools/pubsub_stress/pubsub_stress --publishers 4 --subscribers 8"
+    echo "  ./build-tsan/tools/pubsub_stress/pubsub_stress --slab --rate 0"
+    ;;
   clean)
-    rm -rf build-aarch64 build-host logs
+    rm -rf build-aarch64 build-host build-tsan logs
     echo "Cleaned build directories + logs"
 
     # Optional: if you generate protobuf into the SOURCE tree:
@@ -60,6 +73,7 @@ case "$TARGET" in
     echo "Usage:"
     echo "  ./build.sh        # aarch64 (target deploy)"
     echo "  ./build.sh host   # host build"
+    echo "  ./build.sh tsan   # host build with ThreadSanitizer"
     echo "  ./build.sh clean"
     exit 1
     ;;
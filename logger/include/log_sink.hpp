@@ -0,0 +1,45 @@
+/**
+ * @file log_sink.hpp
+ * @brief Output destinations for Logger.
+ */
+#pragma once
+
+#include <cstddef>   // std::size_t
+
+/**
+ * @class LogSink
+ * @brief Destination for fully formatted log lines.
+ *
+ * Logger formats each message into a single line (including the trailing
+ * newline) and hands it to a sink in one write() call. Implementations must
+ * be thread-safe and must not interleave concurrent lines.
+ */
+class LogSink
+{
+public:
+    virtual ~LogSink() = default;
+
+    /**
+     * @brief Append one formatted line.
+     *
+     * @param data Line bytes, ending with '\n'.
+     * @param len  Number of bytes in @p data.
+     */
+    virtual void write(const char* data, std::size_t len) = 0;
+
+    /// Push buffered output towards its destination. Default: no-op.
+    virtual void flush() {}
+};
+
+/**
+ * @class ConsoleSink
+ * @brief Writes lines to std::cout under the global MutexSingleton lock.
+ *
+ * This is the default sink and matches the original Logger output.
+ */
+class ConsoleSink : public LogSink
+{
+public:
+    void write(const char* data, std::size_t len) override;
+    void flush() override;
+};
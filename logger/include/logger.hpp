@@ -4,13 +4,28 @@
  */
 #pragma once
 
+#include "log_sink.hpp"
+
+#include <atomic>
+#include <cstddef>   // std::size_t
 #include <cstdint>   // std::uint8_t
+#include <memory>
 #include <string>
 
 /**
  * @class Logger
  * @brief Core processing Logger for message logging with levels.
- * 
+ *
+ * Each message is formatted into one line and handed to a LogSink: the
+ * logger's own sink if set, otherwise the process-wide default sink
+ * (a ConsoleSink unless replaced with setDefaultSink()).
+ *
+ * Each logger starts with the threshold passed to its constructor. A
+ * runtime override set with setLevel(const std::string&, Level) (or
+ * setLevels(), e.g. from BEAGLEPLAY_LOG_LEVEL) applies to all loggers with
+ * the same name (trailing spaces ignored), including ones created later,
+ * without touching the owning thread.
+ *
  * Logger is movable but not copyable.
  */
 class Logger
@@ -26,7 +41,7 @@ public:
      */
     enum class Level : std::uint8_t
     {
-        OFF   = 0,  ///< No logging
+        OFF   = 0,  ///< No logging (as a threshold: the logger emits nothing)
         INFO  = 1,  ///< Informational messages
         WARN  = 2,  ///< Warnings
         ERROR = 3,  ///< Recoverable errors
@@ -38,7 +53,9 @@ public:
      *
      * @param name      Human-readable name identifying the logger instance.
      * @param minLevel  Minimum severity level required for messages to be emitted.
-     *                  Messages with a lower level are discarded.
+     *                  Messages with a lower level are discarded, so WARN emits
+     *                  WARN, ERROR and FATAL; OFF emits nothing. Used until an
+     *                  override is set for @p name.
      */
     Logger(const std::string& name, Level minLevel = Level::OFF);
 
@@ -48,8 +65,8 @@ public:
     Logger& operator=(const Logger&) = delete;
 
     /// Logger moving is fine if needed.
-    Logger(Logger&&) = default;
-    Logger& operator=(Logger&&) = default;
+    Logger(Logger&&) noexcept = default;
+    Logger& operator=(Logger&&) noexcept = default;
 
     /**
      * @brief Log a message with an explicit severity level.
@@ -71,9 +88,70 @@ public:
     /// Log a fatal error message.
     void fatal(const std::string& msg) { log(Level::FATAL, msg); }
 
+    /**
+     * @brief Log a printf-style formatted message without heap allocation.
+     *
+     * The message is formatted into a stack buffer of @ref kMaxFormatted bytes
+     * (longer output is truncated), so it is safe to use from runnables that
+     * must not touch the allocator in their steady state.
+     *
+     * @param level Severity level of the message.
+     * @param fmt   printf format string.
+     */
+    void logf(Level level, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+
+    /// Maximum length of a message produced by logf().
+    static constexpr std::size_t kMaxFormatted = 256;
+
+    /// True if a message of @p level would currently be emitted.
+    bool enabled(Level level) const;
+
+    /// Override the threshold of this logger and every logger sharing its name.
+    void setLevel(Level minLevel);
+
+    /// Current threshold of this logger: the override for its name, else its own.
+    Level level() const;
+
+    /**
+     * @brief Override the threshold of all loggers named @p name.
+     *
+     * Takes precedence over the constructor argument. Safe to call from any
+     * thread. Applies to loggers created later as well.
+     */
+    static void setLevel(const std::string& name, Level minLevel);
+
+    /**
+     * @brief Apply a threshold list such as "APP_SUB_A=WARN,APP_PUB=OFF".
+     *
+     * Unknown level names are ignored.
+     *
+     * @return Number of entries applied.
+     */
+    static std::size_t setLevels(const std::string& spec);
+
+    /// Route this logger to @p sink; nullptr returns to the default sink.
+    void setSink(std::shared_ptr<LogSink> sink);
+
+    /**
+     * @brief Replace the sink used by loggers without their own sink.
+     *
+     * The previous sink is kept alive for the rest of the process, so
+     * threads still writing to it are never left with a dangling sink.
+     */
+    static void setDefaultSink(std::shared_ptr<LogSink> sink);
+
 private:
-    std::string m_name;                    ///< Logger name
-    Level       m_minLevel{ Level::OFF };  ///< Minimum severity threshold
+    /// Per-name override; holds kNoOverride until setLevel() is called for the name.
+    using LevelCell = std::atomic<std::uint8_t>;
+    static constexpr std::uint8_t kNoOverride = 0xFF;
+
+    std::string                m_name;      ///< Logger name
+    Level                      m_minLevel;  ///< Threshold from the constructor
+    std::shared_ptr<LevelCell> m_level;     ///< Override shared per name
+    std::shared_ptr<LogSink>   m_sink;   ///< Own sink, or nullptr for the default sink
+
+    /// Emit @p len bytes of @p msg if @p level passes the threshold.
+    void write(Level level, const char* msg, std::size_t len);
 
     /// Convert a log level to a human-readable string.
     static const char*  levelToString(Level lvl);
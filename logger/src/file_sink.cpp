@@ -0,0 +1,165 @@
+/**
+ * @file file_sink.cpp
+ * @brief Memory-mapped, size-rotated log file sink.
+ */
+#include "file_sink.hpp"
+
+#include <cerrno>
+#include <cstdio>      // std::rename, std::remove
+#include <cstring>     // std::memcpy
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+[[noreturn]] void throwErrno(const char* what)
+{
+    throw std::system_error(errno, std::generic_category(), std::string("file_sink: ") + what);
+}
+
+} // namespace
+
+FileSink::FileSink(FileSinkConfig cfg)
+    : m_cfg(std::move(cfg))
+{
+    if (m_cfg.segmentBytes == 0)
+    {
+        throw std::invalid_argument("file_sink: segmentBytes must be > 0");
+    }
+    openSegment();
+    if (m_map == nullptr)
+    {
+        throwErrno(("cannot create segment " + m_cfg.path).c_str());
+    }
+}
+
+FileSink::~FileSink()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    closeSegment();
+}
+
+// Hot path: a memcpy into the mapping. System calls only on rotation.
+void FileSink::write(const char* data, std::size_t len)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_map != nullptr && m_offset + len > m_cfg.segmentBytes && m_offset > 0)
+    {
+        rotate();
+    }
+    if (m_map == nullptr)
+    {
+        openSegment();   // retry after a failed rotation
+        if (m_map == nullptr)
+        {
+            m_dropped++;
+            return;
+        }
+    }
+
+    // A single line longer than a segment is cut to the segment size.
+    const std::size_t n = (len <= m_cfg.segmentBytes - m_offset) ? len : m_cfg.segmentBytes - m_offset;
+    std::memcpy(m_map + m_offset, data, n);
+    m_offset  += n;
+    m_written += n;
+}
+
+void FileSink::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_map != nullptr)
+    {
+        ::msync(m_map, m_cfg.segmentBytes, MS_ASYNC);
+    }
+}
+
+std::uint64_t FileSink::bytesWritten() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_written;
+}
+
+std::uint64_t FileSink::rotations() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_rotations;
+}
+
+std::uint64_t FileSink::dropped() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+}
+
+// Create the active file, reserve a full segment and map it. Leaves m_map null on failure.
+void FileSink::openSegment()
+{
+    m_fd = ::open(m_cfg.path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0) return;
+
+    // Reserve real blocks so a full disk shows up here, not as SIGBUS in write().
+    // No ftruncate() fallback: a sparse file would bring the SIGBUS back.
+    const int rc = ::posix_fallocate(m_fd, 0, static_cast<off_t>(m_cfg.segmentBytes));
+    if (rc != 0)
+    {
+        ::close(m_fd);
+        m_fd  = -1;
+        errno = rc;   // posix_fallocate() returns the error instead of setting errno
+        return;
+    }
+
+    void* p = ::mmap(nullptr, m_cfg.segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (p == MAP_FAILED)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+        return;
+    }
+    m_map    = static_cast<char*>(p);
+    m_offset = 0;
+}
+
+// Unmap and trim the file to the bytes actually written.
+void FileSink::closeSegment()
+{
+    if (m_map != nullptr)
+    {
+        ::munmap(m_map, m_cfg.segmentBytes);
+        m_map = nullptr;
+    }
+    if (m_fd >= 0)
+    {
+        if (::ftruncate(m_fd, static_cast<off_t>(m_offset)) != 0) { /* keep the padded file */ }
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+// path -> path.1 -> ... -> path.maxFiles (oldest is removed), then map a fresh segment.
+void FileSink::rotate()
+{
+    closeSegment();
+
+    if (m_cfg.maxFiles == 0)
+    {
+        std::remove(m_cfg.path.c_str());
+    }
+    else
+    {
+        std::remove((m_cfg.path + "." + std::to_string(m_cfg.maxFiles)).c_str());
+        for (std::size_t i = m_cfg.maxFiles - 1; i >= 1; --i)
+        {
+            std::rename((m_cfg.path + "." + std::to_string(i)).c_str(),
+                        (m_cfg.path + "." + std::to_string(i + 1)).c_str());
+        }
+        std::rename(m_cfg.path.c_str(), (m_cfg.path + ".1").c_str());
+    }
+
+    m_rotations++;
+    openSegment();
+}
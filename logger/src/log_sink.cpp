@@ -0,0 +1,22 @@
+/**
+ * @file log_sink.cpp
+ * @brief Console sink implementation.
+ */
+#include "log_sink.hpp"
+#include "mutex.hpp"
+
+#include <iostream>   // std::cout
+#include <mutex>
+
+// One locked write per line keeps concurrent lines whole.
+void ConsoleSink::write(const char* data, std::size_t len)
+{
+    std::lock_guard<std::mutex> lock(MutexSingleton::instance());
+    std::cout.write(data, static_cast<std::streamsize>(len));
+}
+
+void ConsoleSink::flush()
+{
+    std::lock_guard<std::mutex> lock(MutexSingleton::instance());
+    std::cout.flush();
+}
@@ -4,20 +4,151 @@
  */
 #include "logger.hpp"
 #include "mutex.hpp"
-#include <iostream>   // std::cout, std::endl
+#include "trace.hpp"
+#include <chrono>
+#include <cstdarg>    // va_list
+#include <cstdio>     // std::vsnprintf, std::snprintf
+#include <cstring>    // std::memcpy
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 /**
  * @brief Stores the start time.
  */
 static auto t0 = std::chrono::steady_clock::now();
 
-// Store name and severity threshold; no side effects.
+namespace {
+
+/// Longest line formatted on the stack; longer lines fall back to the heap.
+constexpr std::size_t kMaxLine = 512;
+
+/// Per-name threshold overrides; cells are never removed.
+struct LevelRegistry
+{
+    std::mutex m;
+    std::unordered_map<std::string, std::shared_ptr<std::atomic<std::uint8_t>>> cells;
+};
+
+LevelRegistry& levelRegistry()
+{
+    static LevelRegistry r;
+    return r;
+}
+
+/// Default sink plus every sink it replaced (kept alive, see setDefaultSink()).
+struct SinkRegistry
+{
+    std::mutex                            m;
+    std::vector<std::shared_ptr<LogSink>> owned{ std::make_shared<ConsoleSink>() };
+    std::atomic<LogSink*>                 current{ owned.front().get() };
+};
+
+SinkRegistry& sinkRegistry()
+{
+    static SinkRegistry r;
+    return r;
+}
+
+// "APP_PUB  " and "APP_PUB" share one threshold.
+std::string levelKey(const std::string& name)
+{
+    const auto end = name.find_last_not_of(' ');
+    return (end == std::string::npos) ? std::string() : name.substr(0, end + 1);
+}
+
+std::shared_ptr<std::atomic<std::uint8_t>> levelCell(const std::string& name, std::uint8_t initial)
+{
+    LevelRegistry& r = levelRegistry();
+    std::lock_guard<std::mutex> lock(r.m);
+    auto& cell = r.cells[levelKey(name)];
+    if (!cell) cell = std::make_shared<std::atomic<std::uint8_t>>(initial);
+    return cell;
+}
+
+bool parseLevel(const std::string& text, Logger::Level& out)
+{
+    static const struct { const char* name; Logger::Level level; } kNames[] = {
+        { "OFF", Logger::Level::OFF }, { "INFO", Logger::Level::INFO }, { "WARN", Logger::Level::WARN },
+        { "ERROR", Logger::Level::ERROR }, { "FATAL", Logger::Level::FATAL },
+    };
+    for (const auto& n : kNames)
+    {
+        if (text == n.name) { out = n.level; return true; }
+    }
+    return false;
+}
+
+} // namespace
+
+// Store name and level, and attach to the per-name override.
 Logger::Logger(const std::string& name, Level minLevel)
     : m_name(name),
-      m_minLevel(minLevel)
+      m_minLevel(minLevel),
+      m_level(levelCell(name, kNoOverride))
 {
 }
 
+bool Logger::enabled(Level level) const
+{
+    if (!m_level) return false;   // moved-from
+    const Level min = this->level();
+    // OFF as a threshold silences the logger; OFF is no message severity.
+    return min != Level::OFF && level != Level::OFF && levelValue(level) >= levelValue(min);
+}
+
+void Logger::setLevel(Level minLevel)
+{
+    if (m_level) m_level->store(levelValue(minLevel), std::memory_order_relaxed);
+}
+
+Logger::Level Logger::level() const
+{
+    if (!m_level) return Level::OFF;
+    const std::uint8_t v = m_level->load(std::memory_order_relaxed);
+    return (v == kNoOverride) ? m_minLevel : static_cast<Level>(v);
+}
+
+void Logger::setLevel(const std::string& name, Level minLevel)
+{
+    levelCell(name, kNoOverride)->store(levelValue(minLevel), std::memory_order_relaxed);
+}
+
+std::size_t Logger::setLevels(const std::string& spec)
+{
+    std::size_t applied = 0;
+    std::size_t pos = 0;
+    while (pos <= spec.size())
+    {
+        std::size_t end = spec.find(',', pos);
+        if (end == std::string::npos) end = spec.size();
+        const std::string item = spec.substr(pos, end - pos);
+        const std::size_t eq = item.find('=');
+        Level lvl{};
+        if (eq != std::string::npos && parseLevel(item.substr(eq + 1), lvl))
+        {
+            setLevel(item.substr(0, eq), lvl);
+            applied++;
+        }
+        pos = end + 1;
+    }
+    return applied;
+}
+
+void Logger::setSink(std::shared_ptr<LogSink> sink)
+{
+    m_sink = std::move(sink);
+}
+
+void Logger::setDefaultSink(std::shared_ptr<LogSink> sink)
+{
+    if (!sink) sink = std::make_shared<ConsoleSink>();
+    SinkRegistry& r = sinkRegistry();
+    std::lock_guard<std::mutex> lock(r.m);
+    r.owned.push_back(sink);
+    r.current.store(sink.get(), std::memory_order_release);
+}
+
 // Helper: map enum -> text
 const char* Logger::levelToString(Level lvl)
 {
@@ -38,17 +169,58 @@ std::uint8_t Logger::levelValue(Level lvl)
     return static_cast<std::uint8_t>(lvl);
 }
 
-// Log function: prints "[LEVEL][NAME] msg" if level >= minLevel
+// Log function: emits "[LEVEL][NAME] msg" if level >= minLevel
 void Logger::log(Level level, const std::string& msg)
 {
-    if (levelValue(level) > levelValue(m_minLevel)) return;
+    write(level, msg.data(), msg.size());
+}
+
+// Formatted variant: renders into a stack buffer, never allocates
+void Logger::logf(Level level, const char* fmt, ...)
+{
+    if (!enabled(level)) return;
+
+    char buf[kMaxFormatted];
+    va_list args;
+    va_start(args, fmt);
+    int n = std::vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n < 0) return;
+
+    write(level, buf, (static_cast<std::size_t>(n) < sizeof(buf)) ? static_cast<std::size_t>(n) : sizeof(buf) - 1);
+}
+
+// Shared output path for log() and logf(): one line, one sink write
+void Logger::write(Level level, const char* msg, std::size_t len)
+{
+    if (!enabled(level)) return;
+
+    TRACE_SCOPE("Logger::log");
 
     auto now = std::chrono::steady_clock::now();
     auto ms  = std::chrono::duration_cast<std::chrono::milliseconds>(now - t0).count();
 
-    std::lock_guard<std::mutex> lock(MutexSingleton::instance());
-    std::cout << ms << "ms "
-              << "[" << levelToString(level)
-              << "][" << m_name << "] "
-              << msg << "\n";          // note: no std::endl
+    char line[kMaxLine];
+    const int prefix = std::snprintf(line, sizeof(line), "%lldms [%s][%s] ",
+                                     static_cast<long long>(ms), levelToString(level), m_name.c_str());
+    if (prefix < 0) return;
+
+    LogSink* sink = m_sink ? m_sink.get() : sinkRegistry().current.load(std::memory_order_acquire);
+    const std::size_t head = static_cast<std::size_t>(prefix);
+
+    if (head + len + 1 <= sizeof(line))
+    {
+        std::memcpy(line + head, msg, len);
+        line[head + len] = '\n';
+        sink->write(line, head + len + 1);
+        return;
+    }
+
+    // Rare: long message or name. snprintf truncated, so rebuild on the heap.
+    std::string big = (head < sizeof(line))
+        ? std::string(line, head)
+        : std::to_string(ms) + "ms [" + levelToString(level) + "][" + m_name + "] ";
+    big.append(msg, len);
+    big.push_back('\n');
+    sink->write(big.data(), big.size());
 }
@@ -1,7 +1,13 @@
 // main.cpp
+#include "alloc_tracker.hpp"
+#include "file_sink.hpp"
 #include "logger.hpp"
 #include "runnables.hpp"
+#include "trace.hpp"
 
+#include <csignal>
+#include <pthread.h>
+#include <cstdlib>
 #include <thread>
 #include <chrono>
 #include <string>
@@ -9,8 +15,57 @@
 
 int main()
 {
+    // BEAGLEPLAY_LOG_FILE=<file>: all loggers write to a rotating mmap'd file instead of stdout
+    if (const char* logPath = std::getenv("BEAGLEPLAY_LOG_FILE"))
+    {
+        FileSinkConfig cfg;
+        cfg.path = logPath;
+        Logger::setDefaultSink(std::make_shared<FileSink>(cfg));
+    }
+
+    // BEAGLEPLAY_LOG_LEVEL="APP_SUB_A=WARN,APP_PUB=OFF": per-logger thresholds
+    if (const char* levels = std::getenv("BEAGLEPLAY_LOG_LEVEL"))
+    {
+        Logger::setLevels(levels);
+    }
+
     // MAIN logger shows everything from INFO upwards
     Logger mainLog("MAIN", Logger::Level::INFO);
+
+    // BEAGLEPLAY_TRACE=<file>: record spans, dump them with `kill -USR1 <pid>`
+    const char* tracePath = std::getenv("BEAGLEPLAY_TRACE");
+#if !PROJECT_TRACING
+    if (tracePath)
+    {
+        mainLog.warn("BEAGLEPLAY_TRACE ignored: built with PROJECT_ENABLE_TRACING=OFF");
+        tracePath = nullptr;
+    }
+#endif
+
+    // Block every handled signal before starting any helper thread, so each
+    // helper (and every later thread) inherits a mask that leaves the signal
+    // to the one helper sigwait()ing on it.
+    sigset_t handled;
+    sigemptyset(&handled);
+    if (tracePath) sigaddset(&handled, SIGUSR1);
+    if (alloc_tracker::kEnabled) sigaddset(&handled, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &handled, nullptr);
+
+#if PROJECT_TRACING
+    if (tracePath)
+    {
+        trace::dump_on_signal(SIGUSR1, tracePath);
+        trace::set_enabled(true);
+        mainLog.info(std::string("Tracing enabled, SIGUSR1 dumps to ") + tracePath);
+    }
+#endif
+
+    // PROJECT_ALLOC_TRACKING builds: `kill -USR2 <pid>` prints allocation counters
+    if (alloc_tracker::kEnabled)
+    {
+        alloc_tracker::report_on_signal(SIGUSR2);
+    }
+
     mainLog.info("Starting threads...");
 
     runnables::startDefault(3);
@@ -0,0 +1,274 @@
+/**
+ * @file slab_allocator.hpp
+ * @brief Lock-free size-class slab allocator for variable-length payloads.
+ *
+ * Memory is reserved once, per size class (64 B, 128 B, ... 64 KiB), as one
+ * contiguous arena of equally sized blocks. A block is never split or merged,
+ * so mixed-size traffic cannot fragment the arenas and the total footprint is
+ * fixed at construction.
+ *
+ * Free blocks sit on a lock-free stack per class; each thread additionally
+ * keeps a few blocks per class in a private cache so the common
+ * allocate/release pair touches no shared cache line.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace slab {
+
+/// Smallest block size (bytes).
+inline constexpr std::size_t kMinBlock   = 64;
+/// Largest block size (bytes).
+inline constexpr std::size_t kMaxBlock   = 64 * 1024;
+/// Number of power-of-two size classes between kMinBlock and kMaxBlock.
+inline constexpr std::size_t kClassCount = 11;
+/// Blocks per class kept in each thread's private cache.
+inline constexpr std::size_t kCacheDepth = 8;
+
+static_assert((kMinBlock << (kClassCount - 1)) == kMaxBlock, "size classes out of sync");
+
+/// Block size of class @p cls.
+constexpr std::size_t class_size(std::size_t cls) { return kMinBlock << cls; }
+
+/// Smallest class holding @p bytes, or kClassCount if it is larger than kMaxBlock.
+constexpr std::size_t class_for(std::size_t bytes)
+{
+    std::size_t cls = 0;
+    while (cls < kClassCount && class_size(cls) < bytes) ++cls;
+    return cls;
+}
+
+/**
+ * @brief Arena sizing.
+ *
+ * Each class gets max(bytesPerClass / blockSize, minBlocks) blocks. Keep
+ * minBlocks above "threads x kCacheDepth" plus the number of payloads that
+ * can be alive at once, or blocks parked in idle thread caches can starve
+ * the other threads.
+ */
+struct Config
+{
+    std::size_t bytesPerClass = 128 * 1024;
+    std::size_t minBlocks     = 8;
+};
+
+/// Usage of one size class.
+struct ClassStats
+{
+    std::size_t   blockSize  = 0;  ///< Bytes per block.
+    std::size_t   blocks     = 0;  ///< Blocks in the arena.
+    std::size_t   available  = 0;  ///< Blocks on the shared free list (thread caches excluded).
+    std::uint64_t spills     = 0;  ///< Allocations served here because a smaller class was empty.
+};
+
+/// Snapshot of all size classes.
+struct Stats
+{
+    std::array<ClassStats, kClassCount> classes{};
+    std::uint64_t exhausted = 0;   ///< Requests that found no free block (or exceeded kMaxBlock).
+};
+
+namespace detail {
+class Pool;
+
+/// Return block @p idx of class @p cls to @p pool (last reference dropped).
+void release(Pool* pool, std::uint8_t cls, std::uint32_t idx);
+} // namespace detail
+
+/**
+ * @class Buffer
+ * @brief Reference-counted handle to one slab block.
+ *
+ * Copies share the block (one atomic increment, no data copy); the block goes
+ * back to the slab when the last copy is destroyed. The size can change
+ * within the block's capacity. A default-constructed or failed allocation
+ * yields an empty handle.
+ *
+ * Readers sharing a Buffer must not write to it.
+ */
+class Buffer {
+public:
+    Buffer() = default;
+
+    Buffer(const Buffer& o) noexcept
+        : pool_(o.pool_), data_(o.data_), refs_(o.refs_), size_(o.size_), idx_(o.idx_), cls_(o.cls_)
+    {
+        if (refs_) refs_->fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Buffer(Buffer&& o) noexcept
+        : pool_(o.pool_), data_(o.data_), refs_(o.refs_), size_(o.size_), idx_(o.idx_), cls_(o.cls_)
+    {
+        o.pool_ = nullptr; o.data_ = nullptr; o.refs_ = nullptr; o.size_ = 0;
+    }
+
+    Buffer& operator=(Buffer o) noexcept {
+        swap(o);
+        return *this;
+    }
+
+    ~Buffer() { reset(); }
+
+    /// Drop this reference; the handle becomes empty.
+    void reset() noexcept {
+        if (refs_ && refs_->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            detail::release(pool_, cls_, idx_);
+        }
+        pool_ = nullptr; data_ = nullptr; refs_ = nullptr; size_ = 0;
+    }
+
+    void swap(Buffer& o) noexcept {
+        std::swap(pool_, o.pool_); std::swap(data_, o.data_); std::swap(refs_, o.refs_);
+        std::swap(size_, o.size_); std::swap(idx_, o.idx_);   std::swap(cls_, o.cls_);
+    }
+
+    std::uint8_t*       data()       { return data_; }
+    const std::uint8_t* data() const { return data_; }
+    std::size_t size()     const { return size_; }
+    std::size_t capacity() const { return data_ ? class_size(cls_) : 0; }
+    bool empty()           const { return size_ == 0; }
+    explicit operator bool() const { return data_ != nullptr; }
+
+    /// Number of handles sharing the block (0 for an empty handle).
+    std::uint32_t use_count() const { return refs_ ? refs_->load(std::memory_order_relaxed) : 0; }
+
+    /**
+     * @brief Change the logical size.
+     *
+     * @return false (size unchanged) if @p n exceeds capacity().
+     */
+    bool resize(std::size_t n) {
+        if (n > capacity()) return false;
+        size_ = static_cast<std::uint32_t>(n);
+        return true;
+    }
+
+private:
+    friend class Allocator;
+
+    Buffer(detail::Pool* pool, std::uint8_t* data, std::atomic<std::uint32_t>* refs,
+           std::size_t size, std::uint32_t idx, std::uint8_t cls)
+        : pool_(pool), data_(data), refs_(refs), size_(static_cast<std::uint32_t>(size)), idx_(idx), cls_(cls) {}
+
+    detail::Pool*               pool_ = nullptr;
+    std::uint8_t*               data_ = nullptr;
+    std::atomic<std::uint32_t>* refs_ = nullptr;
+    std::uint32_t               size_ = 0;
+    std::uint32_t               idx_  = 0;
+    std::uint8_t                cls_  = 0;
+};
+
+/**
+ * @class Allocator
+ * @brief Owner of the size-class arenas.
+ *
+ * Thread-safe and lock-free. Buffers and objects from make_shared() may
+ * outlive the Allocator; the arenas are freed when the last block is back,
+ * including blocks parked in thread caches (returned when the thread exits).
+ */
+class Allocator {
+public:
+    explicit Allocator(Config cfg = Config{});
+    ~Allocator();
+
+    /// Non-copyable.
+    Allocator(const Allocator&) = delete;
+    Allocator& operator=(const Allocator&) = delete;
+
+    /**
+     * @brief Take a block of at least @p bytes.
+     *
+     * If the matching class is empty the next larger non-empty class is used.
+     *
+     * @return Buffer of size @p bytes, or an empty handle if the slab is
+     *         exhausted or @p bytes > kMaxBlock.
+     */
+    Buffer allocate(std::size_t bytes);
+
+    /**
+     * @brief Create a T whose object and shared_ptr control block live in one slab block.
+     *
+     * Meant for hub messages: the object and everything it holds go back to
+     * the slab when the last subscriber drops its reference.
+     *
+     * @return The object, or nullptr if the slab is exhausted.
+     */
+    template <typename T, typename... Args>
+    std::shared_ptr<T> make_shared(Args&&... args);
+
+    /// Snapshot of the per-class counters.
+    Stats stats() const;
+
+private:
+    template <typename U> friend class StdAllocator;
+    detail::Pool* pool_;
+};
+
+/**
+ * @class StdAllocator
+ * @brief Standard allocator adapter drawing single blocks from a slab::Allocator.
+ *
+ * Suitable for std::allocate_shared and other single-object allocations up
+ * to kMaxBlock bytes; not for growing containers. Every outstanding block
+ * keeps the arenas alive, so a copy stored next to its own block (as in a
+ * shared_ptr control block) may outlive the Allocator; a copy without
+ * blocks must not.
+ */
+template <typename T>
+class StdAllocator {
+public:
+    using value_type = T;
+
+    explicit StdAllocator(Allocator& a) noexcept : pool_(a.pool_) {}
+    template <typename U>
+    StdAllocator(const StdAllocator<U>& o) noexcept : pool_(o.pool_) {}
+
+    T* allocate(std::size_t n);
+    void deallocate(T* p, std::size_t n) noexcept;
+
+    template <typename U>
+    bool operator==(const StdAllocator<U>& o) const noexcept { return pool_ == o.pool_; }
+    template <typename U>
+    bool operator!=(const StdAllocator<U>& o) const noexcept { return pool_ != o.pool_; }
+
+private:
+    template <typename U> friend class StdAllocator;
+
+    detail::Pool* pool_;
+};
+
+namespace detail {
+/// One block of at least @p bytes; throws std::bad_alloc if none is free.
+void* allocate_raw(Pool* pool, std::size_t bytes);
+/// Return a block from allocate_raw().
+void  deallocate_raw(Pool* pool, void* p, std::size_t bytes) noexcept;
+} // namespace detail
+
+template <typename T>
+T* StdAllocator<T>::allocate(std::size_t n) {
+    static_assert(alignof(T) <= kMinBlock, "slab blocks are 64-byte aligned");
+    return static_cast<T*>(detail::allocate_raw(pool_, n * sizeof(T)));
+}
+
+template <typename T>
+void StdAllocator<T>::deallocate(T* p, std::size_t n) noexcept {
+    detail::deallocate_raw(pool_, p, n * sizeof(T));
+}
+
+template <typename T, typename... Args>
+std::shared_ptr<T> Allocator::make_shared(Args&&... args) {
+    try {
+        return std::allocate_shared<T>(StdAllocator<T>(*this), std::forward<Args>(args)...);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+} // namespace slab
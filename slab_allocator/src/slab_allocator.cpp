@@ -0,0 +1,328 @@
+/**
+ * @file slab_allocator.cpp
+ * @brief Size-class arenas, lock-free free lists and per-thread caches.
+ *
+ * Reference counting of the arenas: the Allocator holds one reference and
+ * every block taken off a shared free list holds one (whether it is in use
+ * or parked in a thread cache). Thread-cache hits therefore touch no shared
+ * state at all.
+ */
+#include "slab_allocator.hpp"
+
+#include <algorithm>
+
+namespace slab {
+
+namespace {
+
+constexpr std::uint32_t kNil        = 0xFFFFFFFFu;
+constexpr std::size_t   kCacheSlots = 4;   ///< Allocators a thread can cache for at once.
+
+} // namespace
+
+namespace detail {
+
+class Pool
+{
+public:
+    struct Class
+    {
+        std::uint8_t* base      = nullptr;
+        std::size_t   blockSize = 0;
+        std::uint32_t blocks    = 0;
+
+        std::unique_ptr<std::atomic<std::uint32_t>[]> next;   ///< Free-list links.
+        std::unique_ptr<std::atomic<std::uint32_t>[]> refs;   ///< Buffer reference counts.
+
+        /// Free-list head: (ABA tag << 32) | block index.
+        alignas(64) std::atomic<std::uint64_t> head{ kNil };
+        std::atomic<std::int64_t>  available{ 0 };
+        std::atomic<std::uint64_t> spills{ 0 };
+    };
+
+    explicit Pool(const Config& cfg)
+    {
+        std::size_t total = 0;
+        for (std::size_t c = 0; c < kClassCount; ++c)
+        {
+            Class& k = classes[c];
+            k.blockSize = class_size(c);
+            k.blocks = static_cast<std::uint32_t>(std::max(cfg.bytesPerClass / k.blockSize, cfg.minBlocks));
+            total += k.blockSize * k.blocks;
+        }
+
+        arena = static_cast<std::uint8_t*>(::operator new(total, std::align_val_t{ kMinBlock }));
+
+        std::uint8_t* p = arena;
+        for (Class& k : classes)
+        {
+            k.base = p;
+            p += k.blockSize * k.blocks;
+            k.next.reset(new std::atomic<std::uint32_t>[k.blocks]);
+            k.refs.reset(new std::atomic<std::uint32_t>[k.blocks]);
+            for (std::uint32_t i = 0; i < k.blocks; ++i)
+            {
+                k.next[i].store(i + 1 < k.blocks ? i + 1 : kNil, std::memory_order_relaxed);
+                k.refs[i].store(0, std::memory_order_relaxed);
+            }
+            k.head.store(0, std::memory_order_relaxed);
+            k.available.store(k.blocks, std::memory_order_relaxed);
+        }
+    }
+
+    ~Pool() { ::operator delete(arena, std::align_val_t{ kMinBlock }); }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    /// Pop a block from the shared list of @p cls; kNil if empty.
+    std::uint32_t pop(std::size_t cls)
+    {
+        Class& k = classes[cls];
+        std::uint64_t h = k.head.load(std::memory_order_acquire);
+        for (;;)
+        {
+            const std::uint32_t idx = static_cast<std::uint32_t>(h);
+            if (idx == kNil) return kNil;
+            const std::uint64_t nh = ((h >> 32) + 1) << 32 | k.next[idx].load(std::memory_order_relaxed);
+            if (k.head.compare_exchange_weak(h, nh, std::memory_order_acquire, std::memory_order_acquire))
+            {
+                k.available.fetch_sub(1, std::memory_order_relaxed);
+                refcount.fetch_add(1, std::memory_order_relaxed);
+                return idx;
+            }
+        }
+    }
+
+    /// Push a block back on the shared list. May destroy the pool.
+    void push(std::size_t cls, std::uint32_t idx)
+    {
+        Class& k = classes[cls];
+        std::uint64_t h = k.head.load(std::memory_order_relaxed);
+        std::uint64_t nh;
+        do
+        {
+            k.next[idx].store(static_cast<std::uint32_t>(h), std::memory_order_relaxed);
+            nh = ((h >> 32) + 1) << 32 | idx;
+        } while (!k.head.compare_exchange_weak(h, nh, std::memory_order_release, std::memory_order_relaxed));
+        k.available.fetch_add(1, std::memory_order_relaxed);
+        unref();
+    }
+
+    void unref()
+    {
+        if (refcount.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+
+    /// Class whose arena contains @p p.
+    std::size_t class_of(const void* p) const
+    {
+        const auto* b = static_cast<const std::uint8_t*>(p);
+        std::size_t c = 0;
+        while (c + 1 < kClassCount && b >= classes[c + 1].base) ++c;
+        return c;
+    }
+
+    std::array<Class, kClassCount> classes;
+    std::atomic<std::int64_t>      refcount{ 1 };   ///< Allocator + blocks off the shared lists.
+    std::atomic<std::uint64_t>     exhausted{ 0 };
+    std::uint8_t*                  arena = nullptr;
+};
+
+} // namespace detail
+
+namespace {
+
+using detail::Pool;
+
+/// Blocks one thread keeps for one allocator.
+struct CacheSlot
+{
+    Pool*       pool   = nullptr;
+    std::size_t cached = 0;
+    std::uint32_t count[kClassCount] {};
+    std::uint32_t idx[kClassCount][kCacheDepth] {};
+};
+
+/// Trivially destructible so it stays usable while other thread_locals are torn down.
+struct ThreadCache
+{
+    CacheSlot slots[kCacheSlots];
+    bool      closed = false;
+};
+
+thread_local ThreadCache t_cache;
+
+void flush(CacheSlot& s)
+{
+    for (std::size_t c = 0; c < kClassCount; ++c)
+    {
+        while (s.count[c] > 0)
+        {
+            s.cached--;
+            s.pool->push(c, s.idx[c][--s.count[c]]);   // the last push may destroy the pool
+        }
+    }
+    s.pool = nullptr;
+}
+
+/// Returns every cached block when the thread exits.
+struct CacheFlusher
+{
+    ~CacheFlusher()
+    {
+        t_cache.closed = true;
+        for (CacheSlot& s : t_cache.slots)
+        {
+            if (s.cached > 0) flush(s);
+        }
+    }
+};
+
+CacheSlot* cache_for(Pool* pool)
+{
+    static thread_local CacheFlusher flusher;
+    (void)flusher;
+
+    ThreadCache& tc = t_cache;
+    if (tc.closed) return nullptr;
+
+    for (CacheSlot& s : tc.slots)
+    {
+        if (s.pool == pool) return &s;
+    }
+    // A slot without blocks holds no reference, so it can be re-targeted.
+    for (CacheSlot& s : tc.slots)
+    {
+        if (s.cached == 0)
+        {
+            s.pool = pool;
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+std::uint32_t take(Pool* pool, std::size_t cls)
+{
+    CacheSlot* s = cache_for(pool);
+    if (s != nullptr && s->count[cls] > 0)
+    {
+        s->cached--;
+        return s->idx[cls][--s->count[cls]];
+    }
+    return pool->pop(cls);
+}
+
+void give(Pool* pool, std::size_t cls, std::uint32_t idx)
+{
+    CacheSlot* s = cache_for(pool);
+    if (s == nullptr)
+    {
+        pool->push(cls, idx);
+        return;
+    }
+    if (s->count[cls] == kCacheDepth)
+    {
+        // Full: hand half back so blocks freed on consumer threads reach producers.
+        for (std::size_t i = 0; i < kCacheDepth / 2; ++i)
+        {
+            s->cached--;
+            pool->push(cls, s->idx[cls][--s->count[cls]]);
+        }
+    }
+    s->idx[cls][s->count[cls]++] = idx;
+    s->cached++;
+}
+
+/// Take a block of class @p cls or larger; kClassCount if none is free.
+std::size_t take_any(Pool* pool, std::size_t cls, std::uint32_t& idx)
+{
+    for (std::size_t c = cls; c < kClassCount; ++c)
+    {
+        idx = take(pool, c);
+        if (idx != kNil)
+        {
+            if (c != cls) pool->classes[c].spills.fetch_add(1, std::memory_order_relaxed);
+            return c;
+        }
+    }
+    pool->exhausted.fetch_add(1, std::memory_order_relaxed);
+    return kClassCount;
+}
+
+} // namespace
+
+void detail::release(Pool* pool, std::uint8_t cls, std::uint32_t idx)
+{
+    give(pool, cls, idx);
+}
+
+void* detail::allocate_raw(Pool* pool, std::size_t bytes)
+{
+    const std::size_t want = class_for(bytes);
+    std::uint32_t idx = kNil;
+    const std::size_t cls = (want < kClassCount) ? take_any(pool, want, idx) : kClassCount;
+    if (cls == kClassCount)
+    {
+        if (want == kClassCount) pool->exhausted.fetch_add(1, std::memory_order_relaxed);
+        throw std::bad_alloc();
+    }
+    const Pool::Class& k = pool->classes[cls];
+    return k.base + std::size_t{ idx } * k.blockSize;
+}
+
+void detail::deallocate_raw(Pool* pool, void* p, std::size_t /*bytes*/) noexcept
+{
+    const std::size_t cls = pool->class_of(p);
+    const Pool::Class& k = pool->classes[cls];
+    const auto idx = static_cast<std::uint32_t>((static_cast<std::uint8_t*>(p) - k.base) / k.blockSize);
+    give(pool, cls, idx);
+}
+
+Allocator::Allocator(Config cfg)
+    : pool_(new detail::Pool(cfg))
+{
+}
+
+Allocator::~Allocator()
+{
+    pool_->unref();
+}
+
+Buffer Allocator::allocate(std::size_t bytes)
+{
+    const std::size_t want = class_for(bytes);
+    if (want == kClassCount)
+    {
+        pool_->exhausted.fetch_add(1, std::memory_order_relaxed);
+        return Buffer();
+    }
+
+    std::uint32_t idx = kNil;
+    const std::size_t cls = take_any(pool_, want, idx);
+    if (cls == kClassCount) return Buffer();
+
+    detail::Pool::Class& k = pool_->classes[cls];
+    k.refs[idx].store(1, std::memory_order_relaxed);
+    return Buffer(pool_, k.base + std::size_t{ idx } * k.blockSize, &k.refs[idx], bytes, idx,
+                  static_cast<std::uint8_t>(cls));
+}
+
+Stats Allocator::stats() const
+{
+    Stats st;
+    for (std::size_t c = 0; c < kClassCount; ++c)
+    {
+        const detail::Pool::Class& k = pool_->classes[c];
+        ClassStats& out = st.classes[c];
+        out.blockSize = k.blockSize;
+        out.blocks    = k.blocks;
+        out.available = static_cast<std::size_t>(std::max<std::int64_t>(0, k.available.load(std::memory_order_relaxed)));
+        out.spills    = k.spills.load(std::memory_order_relaxed);
+    }
+    st.exhausted = pool_->exhausted.load(std::memory_order_relaxed);
+    return st;
+}
+
+} // namespace slab
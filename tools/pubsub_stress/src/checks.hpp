@@ -0,0 +1,83 @@
+/**
+ * @file checks.hpp
+ * @brief Deterministic self-checks run by pubsub_stress instead of the soak.
+ *
+ * Each check prints one line per step and a final PASS/FAIL line, and
+ * returns the process exit code (0 = pass, 1 = fail).
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace stress {
+
+/**
+ * @brief Pass/fail bookkeeping of one check run.
+ */
+struct CheckResult
+{
+    bool ok = true;
+
+    /// Print @p what with ok/FAIL and remember failures.
+    void expect(bool cond, const std::string& what)
+    {
+        std::printf("  %-60s %s\n", what.c_str(), cond ? "ok" : "FAIL");
+        ok = ok && cond;
+    }
+};
+
+/**
+ * @brief Workload of the threaded part of slab_check().
+ */
+struct SlabRun
+{
+    std::size_t publishers  = 1;
+    std::size_t subscribers = 3;
+    std::size_t depth       = 3;
+    double      rateHz      = 0.0;    ///< Per publisher; 0 = unthrottled.
+    double      durationS   = 10.0;
+};
+
+/**
+ * @brief UdpSender -> UdpReceiver over 127.0.0.1.
+ *
+ * Covers the round trip of headers and payloads, forwarding of a recycled
+ * message object, the receiver's loss / reorder / duplicate / stale
+ * accounting, that only the newest frames are published, and a sender
+ * restart.
+ */
+int udp_check();
+
+/**
+ * @brief slab::Allocator and message_types::Frame through a ConnectionHub.
+ *
+ * Deterministic part: exhaustion, reuse after free and release from
+ * another thread. Threaded part: publishers send frames with random
+ * payload sizes through a ConnectionHub<Frame>, subscribers verify the
+ * contents and drop them on their own threads; at the end every block must
+ * be back on the free lists. Meant to be run under ThreadSanitizer as well.
+ */
+int slab_check(const SlabRun& run);
+
+/**
+ * @brief MultiHub channels routed through a Dispatcher.
+ *
+ * Three message types: per-type and generic handlers, handler order,
+ * conflation, types without a handler left unpolled, and a threaded run()
+ * fed by two publishers that must deliver the last message of each type.
+ */
+int multihub_check();
+
+/**
+ * @brief streams::HeaderHistory queries on hand-built and pseudo-random headers.
+ *
+ * Covers the ring seam (a window split into two pieces), the 16-bit
+ * counter wrap in gaps() and the step across the seam in interval_range(),
+ * then compares every query against a plain loop for windows on both sides
+ * of the seam.
+ */
+int history_check();
+
+} // namespace stress
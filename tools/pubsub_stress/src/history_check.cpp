@@ -0,0 +1,187 @@
+/**
+ * @file history_check.cpp
+ * @brief Deterministic check of streams::HeaderHistory (pubsub_stress --history-check).
+ */
+#include "checks.hpp"
+
+#include "streams/header_history.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace stress {
+
+namespace {
+
+using connection_hub::streams::HeaderHistory;
+using Counter = HeaderHistory::Counter;
+
+constexpr std::uint8_t kError = 2;
+
+/**
+ * 13 headers into a history of capacity 8: records 5..12 are retained, at
+ * ring slots 5, 6, 7 then 0..4. The seam between slot 7 and slot 0 is where
+ * the cycle counter wraps 65535 -> 0 and the measurement counter skips 0,
+ * 1 and 2.
+ */
+void fill_seam_history(HeaderHistory& h)
+{
+    for (std::uint16_t k = 0; k < 13; ++k)
+    {
+        HeaderHistory::Sample s;
+        s.cycleCounter       = static_cast<std::uint16_t>(65528 + k);
+        s.measurementCounter = static_cast<std::uint16_t>(65528 + k + (k >= 8 ? 3 : 0));
+        s.sigStatus          = (k == 7 || k == 8) ? kError : 1;
+        s.sensorSource       = static_cast<std::uint8_t>(k == 7 ? 1 : k == 8 ? 2 : 0);
+        // Steps of 1000 ns, except 700 / 1300 around record 6 and 5000 across the seam.
+        s.timestampNs = k <= 7 ? 1000 * k : 12000 + 1000 * (k - 8);
+        if (k == 6) s.timestampNs = 5700;
+        h.record(s);
+    }
+}
+
+void check_seam_and_wrap(CheckResult& r)
+{
+    HeaderHistory h(8);
+    fill_seam_history(h);
+    r.expect(h.size() == 8 && h.recorded() == 13, "ring wrapped: 8 of 13 headers retained");
+
+    const auto cycle = h.gaps(Counter::Cycle, 8);
+    r.expect(cycle.gaps == 0 && cycle.missing == 0, "cycle 65535 -> 0 across the seam is not a gap");
+
+    const auto meas = h.gaps(Counter::Measurement, 8);
+    r.expect(meas.gaps == 1 && meas.missing == 3, "measurement 65535 -> 3 across the seam: 1 gap, 3 missing");
+
+    const auto inSecond = h.gaps(Counter::Measurement, 5);
+    const auto withSeam = h.gaps(Counter::Measurement, 6);
+    r.expect(inSecond.gaps == 0 && withSeam.gaps == 1 && withSeam.missing == 3,
+             "window boundary: 5 stays after the seam, 6 crosses it");
+
+    const auto range = h.minmax(Counter::Cycle, 8);
+    r.expect(range && range->min == 0 && range->max == 65535, "minmax spans both pieces");
+
+    const auto spacing = h.interval_range(8);
+    r.expect(spacing && spacing->min == 700 && spacing->max == 5000, "interval_range includes the step across the seam");
+
+    const auto tail = h.interval_range(5);
+    r.expect(tail && tail->min == 1000 && tail->max == 1000, "interval_range within one piece");
+    r.expect(!h.interval_range(1), "interval_range needs two headers");
+
+    const auto bySource = h.count_status_by_source(kError, 8);
+    r.expect(h.count_status(kError, 8) == 2 && bySource[1] == 1 && bySource[2] == 1,
+             "status counts on both sides of the seam");
+    r.expect(h.count_status(kError, 4) == 0, "status count limited to the window");
+}
+
+void check_empty(CheckResult& r)
+{
+    const HeaderHistory h(16);
+    const auto g = h.gaps(Counter::Cycle, 16);
+    r.expect(h.size() == 0 && g.gaps == 0 && h.count_status(kError, 16) == 0 && !h.minmax(Counter::Cycle, 16) &&
+                 !h.interval_range(16),
+             "empty history: zero counts, no ranges");
+}
+
+/// Window of recorded samples, oldest first, with a plain-loop gaps().
+struct Reference
+{
+    std::vector<HeaderHistory::Sample> samples;
+
+    HeaderHistory::GapStats gaps() const
+    {
+        HeaderHistory::GapStats g;
+        for (std::size_t i = 1; i < samples.size(); ++i)
+        {
+            const auto d = static_cast<std::uint16_t>(samples[i].cycleCounter - samples[i - 1].cycleCounter);
+            if (d != 1) g.gaps++;
+            if (d > 1) g.missing += d - 1u;
+        }
+        return g;
+    }
+};
+
+// Pseudo-random headers (fixed seed) against the reference, for several windows.
+void check_against_reference(CheckResult& r)
+{
+    constexpr std::size_t kCapacity = 4096;
+    constexpr std::size_t kRecords  = 2 * kCapacity + 123;
+    HeaderHistory h(kCapacity);
+    std::vector<HeaderHistory::Sample> all;
+    all.reserve(kRecords);
+
+    std::uint32_t rng = 12345;
+    std::uint16_t cycle = 60000;
+    std::int64_t ts = 0;
+    for (std::size_t k = 0; k < kRecords; ++k)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        const std::uint32_t x = rng >> 8;
+        cycle = static_cast<std::uint16_t>(cycle + ((x % 50 == 0) ? 1 + x % 7 : 1));   // occasional drops
+        ts += 1000 + static_cast<std::int64_t>(x % 501);
+        HeaderHistory::Sample s{ cycle, static_cast<std::uint16_t>(x), static_cast<std::uint8_t>(x % 4),
+                                 static_cast<std::uint8_t>((x >> 4) % 5), ts };
+        h.record(s);
+        all.push_back(s);
+    }
+
+    bool ok = true;
+    for (std::size_t window : { std::size_t{1}, std::size_t{2}, std::size_t{123}, std::size_t{124},
+                                std::size_t{1000}, kCapacity, kCapacity + 1 })
+    {
+        const std::size_t n = std::min(window, kCapacity);
+        Reference ref{ std::vector<HeaderHistory::Sample>(all.end() - static_cast<std::ptrdiff_t>(n), all.end()) };
+
+        std::size_t errors = 0;
+        std::array<std::uint32_t, 256> bySource{};
+        std::uint16_t lo = std::numeric_limits<std::uint16_t>::max();
+        std::uint16_t hi = 0;
+        std::int64_t stepLo = std::numeric_limits<std::int64_t>::max();
+        std::int64_t stepHi = std::numeric_limits<std::int64_t>::min();
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const auto& s = ref.samples[i];
+            errors += s.sigStatus == kError;
+            bySource[s.sensorSource] += s.sigStatus == kError;
+            lo = std::min(lo, s.cycleCounter);
+            hi = std::max(hi, s.cycleCounter);
+            if (i > 0)
+            {
+                stepLo = std::min(stepLo, s.timestampNs - ref.samples[i - 1].timestampNs);
+                stepHi = std::max(stepHi, s.timestampNs - ref.samples[i - 1].timestampNs);
+            }
+        }
+
+        const auto g = h.gaps(Counter::Cycle, window);
+        const auto expected = ref.gaps();
+        const auto range = h.minmax(Counter::Cycle, window);
+        const auto spacing = h.interval_range(window);
+        const bool match = h.count_status(kError, window) == errors &&
+                           h.count_status_by_source(kError, window) == bySource &&
+                           g.gaps == expected.gaps && g.missing == expected.missing &&
+                           range && range->min == lo && range->max == hi &&
+                           (n < 2 ? !spacing : (spacing && spacing->min == stepLo && spacing->max == stepHi));
+        if (!match) std::printf("  window %zu differs from the reference\n", window);
+        ok = ok && match;
+    }
+    r.expect(ok, "random headers: every query matches a plain loop");
+}
+
+} // namespace
+
+int history_check()
+{
+    std::printf("pubsub_stress: HeaderHistory check\n");
+    CheckResult r;
+    check_seam_and_wrap(r);
+    check_empty(r);
+    check_against_reference(r);
+    std::printf("history: %s\n", r.ok ? "PASS" : "FAIL");
+    return r.ok ? 0 : 1;
+}
+
+} // namespace stress
@@ -0,0 +1,168 @@
+/**
+ * @file multihub_check.cpp
+ * @brief MultiHub / Dispatcher routing check (pubsub_stress --multihub).
+ */
+#include "checks.hpp"
+
+#include "multi_hub.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace stress {
+
+namespace {
+
+struct Imu
+{
+    std::uint32_t seq = 0;
+};
+
+struct Radar
+{
+    std::uint32_t seq = 0;
+};
+
+struct Status
+{
+    std::uint32_t seq = 0;
+};
+
+using Hub = connection_hub::MultiHub<Imu, Radar, Status>;
+using Clock = std::chrono::steady_clock;
+
+static_assert(Hub::kTypeCount == 3 && Hub::index_of<Imu>() == 0 && Hub::index_of<Status>() == 2,
+              "channels are indexed in declaration order");
+
+struct ImuOnly
+{
+    void operator()(const std::shared_ptr<Imu>&) const {}
+};
+
+using ImuDispatcher = connection_hub::Dispatcher<Hub, ImuOnly>;
+static_assert(ImuDispatcher::kAccepts<ImuOnly, Imu> && !ImuDispatcher::kAccepts<ImuOnly, Radar>,
+              "a handler is routed only the types it is invocable with");
+
+// Routing on one thread: per-type handlers, a generic handler, conflation, order.
+void check_routing(CheckResult& r)
+{
+    Hub hub(4);
+    auto imuPub    = hub.make_publisher<Imu>();
+    auto radarPub  = hub.make_publisher<Radar>();
+    auto statusPub = hub.make_publisher<Status>();
+
+    std::vector<std::string> calls;
+    std::uint32_t lastRadar = 0;
+    auto dispatcher = connection_hub::make_dispatcher(
+        hub,
+        [&](const std::shared_ptr<Imu>& m) { calls.push_back("imu " + std::to_string(m->seq)); },
+        [&](const std::shared_ptr<Radar>& m) {
+            lastRadar = m->seq;
+            calls.push_back("radar " + std::to_string(m->seq));
+        },
+        [&](const auto& m) {   // every carried type
+            using T = typename std::decay_t<decltype(m)>::element_type;
+            calls.push_back(std::is_same_v<T, Imu>     ? "any imu"
+                            : std::is_same_v<T, Radar> ? "any radar"
+                                                       : "any status");
+        });
+
+    r.expect(dispatcher.dispatch_once() == 0 && calls.empty(), "nothing published: nothing delivered");
+
+    imuPub.publish(std::make_shared<Imu>(Imu{ 1 }));
+    const std::size_t first = dispatcher.dispatch_once();
+    r.expect(first == 1 && calls == std::vector<std::string>{ "imu 1", "any imu" },
+             "Imu reaches its handler, then the generic one");
+
+    calls.clear();
+    radarPub.publish(std::make_shared<Radar>(Radar{ 1 }));
+    radarPub.publish(std::make_shared<Radar>(Radar{ 2 }));
+    statusPub.publish(std::make_shared<Status>(Status{ 7 }));
+    const std::size_t second = dispatcher.dispatch_once();
+    r.expect(second == 2 && lastRadar == 2 &&
+                 calls == std::vector<std::string>{ "radar 2", "any radar", "any status" },
+             "Radar conflated, Status only to the generic handler");
+
+    calls.clear();
+    r.expect(dispatcher.dispatch_once() == 0 && calls.empty(), "no re-delivery without a new publish");
+    r.expect(hub.publish_count() == 4, "publish_count counts every channel");
+}
+
+// A type no handler accepts is never polled, so its publishes are not consumed.
+void check_unrouted(CheckResult& r)
+{
+    Hub hub(2);
+    std::size_t imus = 0;
+    auto dispatcher = connection_hub::make_dispatcher(hub, [&](const std::shared_ptr<Imu>&) { imus++; });
+
+    hub.make_publisher<Radar>().publish(std::make_shared<Radar>());
+    hub.make_publisher<Status>().publish(std::make_shared<Status>());
+    r.expect(dispatcher.dispatch_once() == 0 && imus == 0, "types without a handler are skipped");
+
+    std::uint64_t seen = 0;
+    r.expect(hub.make_receiver<Radar>().try_get_newer(seen).has_value(), "skipped channel still holds its message");
+}
+
+// Two publisher threads, one dispatcher thread sleeping on the shared doorbell.
+void check_threaded(CheckResult& r)
+{
+    constexpr std::uint32_t kCount = 20000;
+    Hub hub(8);
+
+    std::atomic<std::uint32_t> lastImu{ 0 };
+    std::atomic<std::uint32_t> lastRadar{ 0 };
+    std::atomic<std::uint64_t> backwards{ 0 };
+    auto dispatcher = connection_hub::make_dispatcher(
+        hub,
+        [&](const std::shared_ptr<Imu>& m) {
+            if (m->seq <= lastImu.load(std::memory_order_relaxed)) backwards++;
+            lastImu.store(m->seq, std::memory_order_relaxed);
+        },
+        [&](const std::shared_ptr<Radar>& m) {
+            if (m->seq <= lastRadar.load(std::memory_order_relaxed)) backwards++;
+            lastRadar.store(m->seq, std::memory_order_relaxed);
+        });
+
+    std::atomic<bool> running{ true };
+    std::thread consumer([&] { dispatcher.run(running, std::chrono::milliseconds(10)); });
+    std::thread imu([pub = hub.make_publisher<Imu>()]() mutable {
+        for (std::uint32_t i = 1; i <= kCount; ++i) pub.publish(std::make_shared<Imu>(Imu{ i }));
+    });
+    std::thread radar([pub = hub.make_publisher<Radar>()]() mutable {
+        for (std::uint32_t i = 1; i <= kCount; ++i) pub.publish(std::make_shared<Radar>(Radar{ i }));
+    });
+    imu.join();
+    radar.join();
+
+    const auto deadline = Clock::now() + std::chrono::seconds(2);
+    while ((lastImu.load() != kCount || lastRadar.load() != kCount) && Clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    running.store(false, std::memory_order_relaxed);
+    consumer.join();
+
+    r.expect(lastImu.load() == kCount && lastRadar.load() == kCount, "run() delivers the last message of each type");
+    r.expect(backwards.load() == 0, "per-type delivery never goes back in sequence");
+}
+
+} // namespace
+
+int multihub_check()
+{
+    std::printf("pubsub_stress: MultiHub / Dispatcher check\n");
+    CheckResult r;
+    check_routing(r);
+    check_unrouted(r);
+    check_threaded(r);
+    std::printf("multihub: %s\n", r.ok ? "PASS" : "FAIL");
+    return r.ok ? 0 : 1;
+}
+
+} // namespace stress
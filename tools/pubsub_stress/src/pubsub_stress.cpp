@@ -0,0 +1,688 @@
+/**
+ * @file pubsub_stress.cpp
+ * @brief Configurable soak / stress harness for the pub/sub pipeline.
+ *
+ * Runs N publisher and M subscriber threads over one ConnectionHub and
+ * periodically reports throughput, overwrite (loss) rate, delivery latency
+ * percentiles, RSS growth and per-thread CPU usage. With --flow the
+ * subscribers are sequenced through FlowControl phases like startDefault().
+ *
+ * Build with -DPROJECT_ENABLE_TSAN=ON to run the same workload under
+ * ThreadSanitizer.
+ *
+ * With --callbacks N the subscribers are callback subscriptions
+ * (ConnectionHub::subscribe) sharing a WorkerPool of N threads instead of
+ * one polling thread each, so both delivery models can be compared.
+ *
+ * With --history N every published header is also recorded into a
+ * streams::HeaderHistory hub stage, and each report runs its window
+ * queries over the full history and prints how long they took.
+ * --history-check instead runs the deterministic HeaderHistory check.
+ *
+ * With --udp the soak is replaced by a loopback check of the UDP gateway,
+ * with --slab by a check of slab::Allocator and message_types::Frame
+ * traffic through a ConnectionHub<Frame>, with --multihub by a check of
+ * MultiHub / Dispatcher routing (see checks.hpp).
+ *
+ * With --zero-heap publishers recycle messages through a MessagePool and,
+ * when built with -DPROJECT_ALLOC_TRACKING=ON, the run fails (exit code 1)
+ * if any publisher, subscriber or pool worker thread allocates after the
+ * warm-up.
+ */
+#include "alloc_tracker.hpp"
+#include "checks.hpp"
+#include "connection_hub.hpp"
+#include "executor.hpp"
+#include "message_pool.hpp"
+#include "flow_control.hpp"
+#include "streams/header_history.hpp"
+#include "message.pb.h"
+#include "stress_metrics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Hub   = connection_hub::ConnectionHub<message_payload_one::Message>;
+using Clock = std::chrono::steady_clock;
+
+/// Bytes at the start of every payload: publisher id, sequence, publish time.
+constexpr std::size_t kStampSize = 4 + 8 + 8;
+
+/// FlowControl only knows three participants.
+constexpr std::size_t kMaxFlowSubscribers = 3;
+
+struct Config
+{
+    std::size_t publishers  = 1;
+    std::size_t subscribers = 3;
+    double      rateHz      = 50.0;   ///< Per publisher; 0 = unthrottled.
+    std::size_t payload     = 64;     ///< Bytes, at least kStampSize.
+    std::size_t depth       = 3;
+    double      durationS   = 10.0;   ///< 0 = until SIGINT.
+    double      reportS     = 1.0;
+    long        pollUs      = 100;    ///< Subscriber sleep when nothing new.
+    bool        flow        = false;
+    bool        zeroHeap    = false;
+    double      warmupS     = 1.0;    ///< Allocation checks start after this.
+    std::size_t workers     = 0;      ///< > 0: callback subscribers on a pool of this size.
+    std::size_t history     = 0;      ///< > 0: HeaderHistory stage of this capacity.
+    bool        udp         = false;  ///< Run the UDP gateway check instead of the soak.
+    bool        slab        = false;  ///< Run the slab / Frame check instead of the soak.
+    bool        historyCheck = false; ///< Run the HeaderHistory check instead of the soak.
+    bool        multihub    = false;  ///< Run the MultiHub / Dispatcher check instead of the soak.
+};
+
+/**
+ * @brief Per-thread allocation count over the steady state.
+ *
+ * The baseline is taken by the thread itself the first time it sees the
+ * steady-state flag, since alloc_tracker counters are per calling thread.
+ */
+struct SteadyAllocs
+{
+    std::atomic<std::uint64_t> allocs{0};
+    std::atomic<std::uint64_t> bytes{0};
+};
+
+struct PublisherState
+{
+    stress::ThreadCpuClock     cpu;
+    std::atomic<std::int64_t>  finalCpuNs{0};
+    std::atomic<std::uint64_t> published{0};
+    SteadyAllocs               steady;
+};
+
+struct SubscriberState
+{
+    stress::ThreadCpuClock     cpu;
+    std::atomic<std::int64_t>  finalCpuNs{0};
+    stress::LatencyHistogram   latency;
+    std::atomic<std::uint64_t> received{0};
+    std::atomic<std::uint64_t> missed{0};
+    std::vector<std::uint64_t> lastSeq;   ///< Owned by the subscriber thread.
+    SteadyAllocs               steady;
+};
+
+/// CPU and allocations of one WorkerPool thread (--callbacks).
+struct WorkerState
+{
+    stress::ThreadCpuClock cpu;
+    std::int64_t           finalCpuNs = 0;   ///< Taken before the pool is stopped.
+    SteadyAllocs           steady;           ///< Stored when the worker exits.
+};
+
+std::atomic<bool> g_running{true};
+std::atomic<bool> g_steady{false};
+
+/**
+ * @brief Thread-side helper feeding SteadyAllocs.
+ */
+class AllocWatch
+{
+public:
+    explicit AllocWatch(SteadyAllocs& out) : out_(out) {}
+
+    /// Call once per loop iteration.
+    void poll()
+    {
+        if (!armed_ && g_steady.load(std::memory_order_relaxed))
+        {
+            base_  = alloc_tracker::thread_counters();
+            armed_ = true;
+        }
+    }
+
+    ~AllocWatch()
+    {
+        if (!armed_) return;
+        const auto d = alloc_tracker::thread_counters() - base_;
+        out_.allocs.store(d.allocs, std::memory_order_relaxed);
+        out_.bytes.store(d.bytes, std::memory_order_relaxed);
+    }
+
+private:
+    SteadyAllocs&          out_;
+    alloc_tracker::Counters base_;
+    bool                   armed_ = false;
+};
+
+/// Watch of the current WorkerPool thread; polled by the callbacks it runs.
+thread_local std::unique_ptr<AllocWatch> t_workerWatch;
+
+/// "N (B B)", or "n/a" when the tracker is compiled out and nothing was counted.
+std::string format_allocs(const SteadyAllocs& s)
+{
+    if (!alloc_tracker::kEnabled) return "n/a";
+    return std::to_string(s.allocs.load()) + " (" + std::to_string(s.bytes.load()) + " B)";
+}
+
+extern "C" void on_sigint(int) { g_running.store(false, std::memory_order_relaxed); }
+
+std::int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+void usage(const char* argv0)
+{
+    std::cout
+        << "Usage: " << argv0 << " [options]\n"
+        << "  --publishers N   publisher threads (default 1)\n"
+        << "  --subscribers N  subscriber threads (default 3)\n"
+        << "  --rate HZ        messages/s per publisher, 0 = unthrottled (default 50)\n"
+        << "  --payload BYTES  payload size, >= " << kStampSize << " (default 64)\n"
+        << "  --depth N        hub ring depth (default 3)\n"
+        << "  --duration S     run time in seconds, 0 = until Ctrl-C (default 10)\n"
+        << "  --report S       report interval in seconds (default 1)\n"
+        << "  --poll-us US     subscriber idle sleep in microseconds (default 100)\n"
+        << "  --flow           sequence subscribers through FlowControl (max "
+        << kMaxFlowSubscribers << ")\n"
+        << "  --zero-heap      recycle messages; fail if the steady state allocates\n"
+        << "  --warmup S       seconds before allocation checks start (default 1)\n"
+        << "  --callbacks N    push model: subscribers are callbacks on a pool of N workers\n"
+        << "  --history N      record headers in a HeaderHistory stage, time its queries\n"
+        << "  --history-check  check HeaderHistory queries (ring seam, counter wrap)\n"
+        << "  --udp            check the UDP gateway over loopback instead of the soak\n"
+        << "  --slab           check slab-backed Frames through a hub instead of the soak\n"
+        << "  --multihub       check MultiHub / Dispatcher routing instead of the soak\n";
+}
+
+bool parse_args(int argc, char** argv, Config& cfg)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            return argv[++i];
+        };
+
+        if      (arg == "--publishers")  cfg.publishers  = std::stoul(value());
+        else if (arg == "--subscribers") cfg.subscribers = std::stoul(value());
+        else if (arg == "--rate")        cfg.rateHz      = std::stod(value());
+        else if (arg == "--payload")     cfg.payload     = std::stoul(value());
+        else if (arg == "--depth")       cfg.depth       = std::stoul(value());
+        else if (arg == "--duration")    cfg.durationS   = std::stod(value());
+        else if (arg == "--report")      cfg.reportS     = std::stod(value());
+        else if (arg == "--poll-us")     cfg.pollUs      = std::stol(value());
+        else if (arg == "--flow")        cfg.flow        = true;
+        else if (arg == "--zero-heap")   cfg.zeroHeap    = true;
+        else if (arg == "--warmup")      cfg.warmupS     = std::stod(value());
+        else if (arg == "--callbacks")   cfg.workers     = std::stoul(value());
+        else if (arg == "--history")     cfg.history     = std::stoul(value());
+        else if (arg == "--history-check") cfg.historyCheck = true;
+        else if (arg == "--udp")         cfg.udp         = true;
+        else if (arg == "--slab")        cfg.slab        = true;
+        else if (arg == "--multihub")    cfg.multihub    = true;
+        else if (arg == "--help" || arg == "-h") { usage(argv[0]); return false; }
+        else throw std::invalid_argument("unknown option " + arg);
+    }
+
+    if (cfg.publishers == 0 || cfg.depth == 0 || cfg.reportS <= 0.0)
+        throw std::invalid_argument("--publishers, --depth and --report must be > 0");
+    if (cfg.payload < kStampSize)
+        throw std::invalid_argument("--payload must be >= " + std::to_string(kStampSize));
+    if (cfg.flow && (cfg.subscribers == 0 || cfg.subscribers > kMaxFlowSubscribers))
+        throw std::invalid_argument("--flow supports 1.." + std::to_string(kMaxFlowSubscribers) + " subscribers");
+    if (cfg.flow && cfg.workers > 0)
+        throw std::invalid_argument("--flow and --callbacks are mutually exclusive");
+    return true;
+}
+
+void run_publisher(const Config& cfg, std::uint32_t id, Hub::Publisher pub, PublisherState& st)
+{
+    st.cpu.bind();
+    AllocWatch watch(st.steady);
+
+    // hub depth + one per subscriber + the message being filled
+    std::unique_ptr<connection_hub::MessagePool<message_payload_one::Message>> pool;
+    if (cfg.zeroHeap)
+    {
+        pool = std::make_unique<connection_hub::MessagePool<message_payload_one::Message>>(
+            cfg.depth + cfg.subscribers + 2);
+    }
+
+    const auto period = cfg.rateHz > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / cfg.rateHz))
+        : Clock::duration::zero();
+    auto next = Clock::now();
+    std::uint64_t seq = 0;
+
+    while (g_running.load(std::memory_order_relaxed))
+    {
+        watch.poll();
+
+        auto msg = pool ? pool->acquire() : std::make_shared<message_payload_one::Message>();
+        auto* header = msg->mutable_header();
+        header->set_cyclecounter(static_cast<std::uint16_t>(seq));
+        header->set_reserved0(id);
+
+        // Resizing in place reuses the recycled string's capacity.
+        std::string& payload = *msg->mutable_payload();
+        payload.resize(cfg.payload);
+        const std::int64_t stamp = now_ns();
+        std::memcpy(&payload[0], &id, 4);
+        std::memcpy(&payload[4], &seq, 8);
+        std::memcpy(&payload[12], &stamp, 8);
+
+        pub.publish(std::move(msg));
+        seq++;
+        st.published.fetch_add(1, std::memory_order_relaxed);
+
+        if (period != Clock::duration::zero())
+        {
+            next += period;
+            const auto now = Clock::now();
+            // Fell far behind (e.g. suspended): restart the schedule instead of bursting.
+            if (now - next > std::chrono::seconds(1)) next = now;
+            std::this_thread::sleep_until(next);
+        }
+    }
+    st.finalCpuNs.store(st.cpu.cpu_ns(), std::memory_order_relaxed);
+}
+
+// Account one message: latency, and sequence gaps per publisher (= overwritten in the hub).
+void consume(const message_payload_one::Message& m, SubscriberState& st)
+{
+    const std::string& p = m.payload();
+    if (p.size() < kStampSize) return;
+
+    std::uint32_t pubId = 0;
+    std::uint64_t seq   = 0;
+    std::int64_t  stamp = 0;
+    std::memcpy(&pubId, p.data(), 4);
+    std::memcpy(&seq, p.data() + 4, 8);
+    std::memcpy(&stamp, p.data() + 12, 8);
+
+    st.latency.record(now_ns() - stamp);
+    st.received.fetch_add(1, std::memory_order_relaxed);
+
+    // lastSeq holds seq + 1 so that 0 means "nothing seen yet".
+    if (pubId < st.lastSeq.size())
+    {
+        const std::uint64_t expected = st.lastSeq[pubId];
+        if (expected != 0 && seq > expected)
+        {
+            st.missed.fetch_add(seq - expected, std::memory_order_relaxed);
+        }
+        st.lastSeq[pubId] = std::max(expected, seq + 1);
+    }
+}
+
+void run_subscriber(const Config& cfg, Hub::Receiver rx, SubscriberState& st)
+{
+    st.cpu.bind();
+    AllocWatch watch(st.steady);
+    std::uint64_t lastSeen = 0;
+
+    while (g_running.load(std::memory_order_relaxed))
+    {
+        watch.poll();
+        if (auto m = rx.try_get_newer(lastSeen))
+        {
+            consume(**m, st);
+        }
+        else if (cfg.pollUs > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(cfg.pollUs));
+        }
+    }
+    st.finalCpuNs.store(st.cpu.cpu_ns(), std::memory_order_relaxed);
+}
+
+// Subscribers run in consecutive phases {A},{B},{C}. Only A reads g_running;
+// the others observe its decision through the phase hand-over, so every
+// participant leaves after the same cycle and nobody waits on a missing peer.
+void run_flow_subscriber(const Config& cfg, Hub::Receiver rx, SubscriberState& st,
+                         flow_control::FlowControl& fc, flow_control::Id id,
+                         std::atomic<bool>& stopCycle)
+{
+    st.cpu.bind();
+    AllocWatch watch(st.steady);
+    std::uint64_t lastSeen = 0;
+
+    while (true)
+    {
+        watch.poll();
+        if (fc.wait_turn(id) != flow_control::TurnStatus::Granted) continue;
+        if (id == flow_control::Id::A)
+        {
+            stopCycle.store(!g_running.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        const bool stop = stopCycle.load(std::memory_order_relaxed);
+
+        if (!stop)
+        {
+            if (auto m = rx.try_get_newer(lastSeen)) consume(**m, st);
+        }
+        fc.done(id);
+
+        if (stop) break;
+        if (cfg.pollUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(cfg.pollUs));
+    }
+    st.finalCpuNs.store(st.cpu.cpu_ns(), std::memory_order_relaxed);
+}
+
+struct Totals
+{
+    std::uint64_t published = 0;
+    std::uint64_t received  = 0;
+    std::uint64_t missed    = 0;
+    std::int64_t  pubCpuNs  = 0;
+    std::int64_t  subCpuNs  = 0;
+    std::vector<std::int64_t> subCpu;   ///< Per subscriber.
+    stress::LatencyHistogram::Counts latency{};
+};
+
+// In --callbacks mode subscriber CPU is the CPU of the pool workers.
+Totals collect(const std::vector<std::unique_ptr<PublisherState>>& pubs,
+               const std::vector<std::unique_ptr<SubscriberState>>& subs,
+               const std::vector<std::unique_ptr<WorkerState>>& workers, bool final)
+{
+    Totals t;
+    for (const auto& p : pubs)
+    {
+        t.published += p->published.load(std::memory_order_relaxed);
+        t.pubCpuNs  += final ? p->finalCpuNs.load(std::memory_order_relaxed) : p->cpu.cpu_ns();
+    }
+    for (const auto& s : subs)
+    {
+        t.received += s->received.load(std::memory_order_relaxed);
+        t.missed   += s->missed.load(std::memory_order_relaxed);
+        const std::int64_t cpu = final ? s->finalCpuNs.load(std::memory_order_relaxed) : s->cpu.cpu_ns();
+        t.subCpuNs += cpu;
+        t.subCpu.push_back(cpu);
+        stress::accumulate(t.latency, s->latency.snapshot());
+    }
+    for (const auto& w : workers)
+    {
+        const std::int64_t cpu = final ? w->finalCpuNs : w->cpu.cpu_ns();
+        t.subCpuNs += cpu;
+        t.subCpu.push_back(cpu);
+    }
+    return t;
+}
+
+void print_line(const char* tag, double elapsedS, double windowS, const Totals& now, const Totals& prev,
+                std::uint64_t rssStart, std::uint64_t rss)
+{
+    const auto lat  = stress::difference(now.latency, prev.latency);
+    const auto recv = now.received - prev.received;
+    const auto miss = now.missed - prev.missed;
+    const double loss = (recv + miss) ? 100.0 * static_cast<double>(miss) / static_cast<double>(recv + miss) : 0.0;
+    const double cpuScale = 100.0 / (windowS * 1e9);
+
+    std::int64_t subCpuMax = 0;
+    for (std::size_t i = 0; i < now.subCpu.size(); ++i)
+        subCpuMax = std::max(subCpuMax, now.subCpu[i] - (i < prev.subCpu.size() ? prev.subCpu[i] : 0));
+
+    std::printf("[%s %8.1fs] pub %10.1f/s  recv %10.1f/s  loss %6.2f%%  "
+                "lat p50 %8.1fus p99 %8.1fus p99.9 %8.1fus max %8.1fus  "
+                "rss %llu KiB (%+lld)  cpu pub %5.1f%% sub %5.1f%% (max %5.1f%%)\n",
+                tag, elapsedS,
+                static_cast<double>(now.published - prev.published) / windowS,
+                static_cast<double>(recv) / windowS, loss,
+                stress::LatencyHistogram::percentile(lat, 0.50) / 1e3,
+                stress::LatencyHistogram::percentile(lat, 0.99) / 1e3,
+                stress::LatencyHistogram::percentile(lat, 0.999) / 1e3,
+                stress::LatencyHistogram::percentile(lat, 1.0) / 1e3,
+                static_cast<unsigned long long>(rss),
+                static_cast<long long>(rss) - static_cast<long long>(rssStart),
+                static_cast<double>(now.pubCpuNs - prev.pubCpuNs) * cpuScale,
+                static_cast<double>(now.subCpuNs - prev.subCpuNs) * cpuScale,
+                static_cast<double>(subCpuMax) * cpuScale);
+    std::fflush(stdout);
+}
+
+// Run every HeaderHistory query over the whole history and print the results and cost.
+void print_history(const connection_hub::streams::HeaderHistory& h)
+{
+    using connection_hub::streams::HeaderHistory;
+    const std::size_t window = h.capacity();
+
+    const auto t0 = Clock::now();
+    const std::size_t errors = h.count_status(message_payload_one::SIG_STATUS_ERROR, window);
+    const auto bySource      = h.count_status_by_source(message_payload_one::SIG_STATUS_ERROR, window);
+    const auto gaps          = h.gaps(HeaderHistory::Counter::Cycle, window);
+    const auto cycles        = h.minmax(HeaderHistory::Counter::Cycle, window);
+    const auto spacing       = h.interval_range(window);
+    const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+
+    std::uint32_t worstSource = 0;
+    for (std::size_t s = 1; s < bySource.size(); ++s)
+        if (bySource[s] > bySource[worstSource]) worstSource = static_cast<std::uint32_t>(s);
+
+    std::printf("  history %zu/%zu  errors %zu (most from source %u)  cycle gaps %llu missing %llu  "
+                "cycle %u..%u  spacing %.1f..%.1fus  queries %.1fus\n",
+                h.size(), window, errors, worstSource,
+                static_cast<unsigned long long>(gaps.gaps), static_cast<unsigned long long>(gaps.missing),
+                cycles ? cycles->min : 0u, cycles ? cycles->max : 0u,
+                spacing ? static_cast<double>(spacing->min) / 1e3 : 0.0,
+                spacing ? static_cast<double>(spacing->max) / 1e3 : 0.0, us);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Config cfg;
+    try
+    {
+        if (!parse_args(argc, argv, cfg)) return 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[ERROR] " << e.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (cfg.udp) return stress::udp_check();
+    if (cfg.historyCheck) return stress::history_check();
+    if (cfg.multihub) return stress::multihub_check();
+    if (cfg.slab)
+    {
+        return stress::slab_check(stress::SlabRun{ cfg.publishers, cfg.subscribers, cfg.depth,
+                                                   cfg.rateHz, cfg.durationS > 0.0 ? cfg.durationS : 10.0 });
+    }
+
+    std::signal(SIGINT, on_sigint);
+    std::signal(SIGTERM, on_sigint);
+
+    const std::string mode = cfg.flow ? " (FlowControl)"
+        : cfg.workers > 0 ? " (callbacks on " + std::to_string(cfg.workers) + " workers)" : "";
+    std::printf("pubsub_stress: %zu pub x %.1f Hz, %zu sub%s, payload %zu B, depth %zu, duration %.1fs\n",
+                cfg.publishers, cfg.rateHz, cfg.subscribers, mode.c_str(),
+                cfg.payload, cfg.depth, cfg.durationS);
+
+    Hub hub(cfg.depth);
+
+    std::unique_ptr<connection_hub::streams::HeaderHistory> history;
+    if (cfg.history > 0)
+    {
+        history = std::make_unique<connection_hub::streams::HeaderHistory>(cfg.history);
+        hub.add_stage([h = history.get()](const message_payload_one::Message& m) {
+            h->record_header(m.header(), now_ns());
+        });
+    }
+    const std::uint64_t rssStart = stress::rss_kib();
+
+    std::vector<std::unique_ptr<PublisherState>>  pubStates;
+    std::vector<std::unique_ptr<SubscriberState>> subStates;
+    for (std::size_t i = 0; i < cfg.publishers; ++i) pubStates.push_back(std::make_unique<PublisherState>());
+    for (std::size_t i = 0; i < cfg.subscribers; ++i)
+    {
+        subStates.push_back(std::make_unique<SubscriberState>());
+        subStates.back()->lastSeq.assign(cfg.publishers, 0);
+    }
+
+    std::vector<flow_control::FlowControl::Phase> phases;
+    const flow_control::Id flowIds[kMaxFlowSubscribers] = {
+        flow_control::Id::A, flow_control::Id::B, flow_control::Id::C };
+    for (std::size_t i = 0; cfg.flow && i < cfg.subscribers; ++i) phases.push_back({ flowIds[i] });
+    if (phases.empty()) phases.push_back({ flow_control::Id::A });   // unused outside --flow
+    flow_control::FlowControl fc(phases, std::chrono::milliseconds{2000});
+    std::atomic<bool> stopCycle{false};
+
+    // Hub, then pool, then the subscriptions: each is released before what it uses.
+    std::vector<std::unique_ptr<WorkerState>> workerStates;
+    std::unique_ptr<connection_hub::WorkerPool> pool;
+    if (cfg.workers > 0)
+    {
+        for (std::size_t i = 0; i < cfg.workers; ++i) workerStates.push_back(std::make_unique<WorkerState>());
+        pool = std::make_unique<connection_hub::WorkerPool>(cfg.workers, [&workerStates](std::size_t i) {
+            workerStates[i]->cpu.bind();
+            t_workerWatch = std::make_unique<AllocWatch>(workerStates[i]->steady);
+        });
+    }
+    std::vector<Hub::Subscriber> subscriptions;
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; pool && i < cfg.subscribers; ++i)
+    {
+        SubscriberState& st = *subStates[i];
+        subscriptions.push_back(hub.subscribe(
+            [&st](const Hub::MsgPtr& m) {
+                t_workerWatch->poll();
+                consume(*m, st);
+            },
+            *pool));
+    }
+    for (std::size_t i = 0; !pool && i < cfg.subscribers; ++i)
+    {
+        auto rx = hub.make_receiver();
+        SubscriberState& st = *subStates[i];
+        if (cfg.flow)
+            threads.emplace_back([&, rx, i] { run_flow_subscriber(cfg, rx, st, fc, flowIds[i], stopCycle); });
+        else
+            threads.emplace_back([&, rx] { run_subscriber(cfg, rx, st); });
+    }
+    for (std::size_t i = 0; i < cfg.publishers; ++i)
+    {
+        auto pub = hub.make_publisher();
+        PublisherState& st = *pubStates[i];
+        threads.emplace_back([&, pub, i] { run_publisher(cfg, static_cast<std::uint32_t>(i), pub, st); });
+    }
+
+    const auto start    = Clock::now();
+    const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(cfg.reportS));
+    auto nextReport = start + interval;
+    auto lastReport = start;
+    Totals prev;
+
+    while (g_running.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_until(std::min(nextReport, Clock::now() + std::chrono::milliseconds(100)));
+        const auto now = Clock::now();
+        const double elapsed = std::chrono::duration<double>(now - start).count();
+
+        if (now >= nextReport)
+        {
+            Totals cur = collect(pubStates, subStates, workerStates, false);
+            print_line("run", elapsed, std::chrono::duration<double>(now - lastReport).count(),
+                       cur, prev, rssStart, stress::rss_kib());
+            if (history) print_history(*history);
+            prev = cur;
+            lastReport = now;
+            nextReport += interval;
+        }
+        if (!g_steady.load(std::memory_order_relaxed) && elapsed >= cfg.warmupS)
+        {
+            alloc_tracker::reset_sites();
+            g_steady.store(true, std::memory_order_relaxed);
+        }
+        if (cfg.durationS > 0.0 && elapsed >= cfg.durationS)
+        {
+            g_running.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    for (auto& t : threads) t.join();
+
+    for (auto& w : workerStates) w->finalCpuNs = w->cpu.cpu_ns();
+    subscriptions.clear();
+    pool.reset();   // workers exit and store their steady allocs
+
+    const double total = std::chrono::duration<double>(Clock::now() - start).count();
+    const Totals all = collect(pubStates, subStates, workerStates, true);
+    print_line("all", total, total, all, Totals{}, rssStart, stress::rss_kib());
+
+    std::uint64_t steadyAllocs = 0;
+    for (std::size_t i = 0; i < pubStates.size(); ++i)
+    {
+        const PublisherState& st = *pubStates[i];
+        steadyAllocs += st.steady.allocs.load();
+        std::printf("  pub[%zu] cpu %6.2f%%  steady allocs %s\n", i,
+                    100.0 * static_cast<double>(st.finalCpuNs.load()) / (total * 1e9),
+                    format_allocs(st.steady).c_str());
+    }
+    for (std::size_t i = 0; i < subStates.size(); ++i)
+    {
+        const SubscriberState& st = *subStates[i];
+        steadyAllocs += st.steady.allocs.load();
+        std::printf("  sub[%zu] cpu %6.2f%%  recv %llu  missed %llu  steady allocs %s\n", i,
+                    100.0 * static_cast<double>(st.finalCpuNs.load()) / (total * 1e9),
+                    static_cast<unsigned long long>(st.received.load()),
+                    static_cast<unsigned long long>(st.missed.load()),
+                    format_allocs(st.steady).c_str());
+    }
+
+    for (std::size_t i = 0; i < workerStates.size(); ++i)
+    {
+        const WorkerState& st = *workerStates[i];
+        steadyAllocs += st.steady.allocs.load();
+        std::printf("  worker[%zu] cpu %6.2f%%  steady allocs %s\n", i,
+                    100.0 * static_cast<double>(st.finalCpuNs) / (total * 1e9),
+                    format_allocs(st.steady).c_str());
+    }
+
+    if (cfg.flow)
+    {
+        const flow_control::Stats fs = fc.stats();
+        std::printf("  flow phases completed %llu  expired %llu\n",
+                    static_cast<unsigned long long>(fs.phasesCompleted),
+                    static_cast<unsigned long long>(fs.phasesExpired));
+        for (std::size_t i = 0; i < cfg.subscribers; ++i)
+        {
+            const flow_control::ParticipantStats& p = fs.participants[i];
+            std::printf("  flow %c turns %llu  skipped %llu  late done %llu  overruns %llu  wait timeouts %llu\n",
+                        static_cast<char>('A' + i),
+                        static_cast<unsigned long long>(p.turns),
+                        static_cast<unsigned long long>(p.skipped),
+                        static_cast<unsigned long long>(p.lateDone),
+                        static_cast<unsigned long long>(p.overruns),
+                        static_cast<unsigned long long>(p.waitTimeouts));
+        }
+    }
+
+    if (cfg.zeroHeap)
+    {
+        if (!alloc_tracker::kEnabled)
+        {
+            std::printf("zero-heap: not verified, configure with -DPROJECT_ALLOC_TRACKING=ON\n");
+        }
+        else if (steadyAllocs != 0)
+        {
+            std::printf("zero-heap: FAIL, %llu steady-state allocations\n",
+                        static_cast<unsigned long long>(steadyAllocs));
+            alloc_tracker::report(std::cout);
+            return 1;
+        }
+        else
+        {
+            std::printf("zero-heap: PASS\n");
+        }
+    }
+    return 0;
+}
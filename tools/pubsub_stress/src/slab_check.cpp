@@ -0,0 +1,231 @@
+/**
+ * @file slab_check.cpp
+ * @brief Slab allocator and Frame hub check (pubsub_stress --slab).
+ */
+#include "checks.hpp"
+
+#include "connection_hub.hpp"
+#include "message_types.hpp"
+#include "slab_allocator.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace stress {
+
+namespace {
+
+using FrameHub = connection_hub::ConnectionHub<message_types::Frame>;
+using Clock    = std::chrono::steady_clock;
+
+/// Largest payload the threaded part sends.
+constexpr std::size_t kMaxPayload = 16 * 1024;
+
+// Payload byte k of a frame, derived from its header so any reader can check it.
+std::uint8_t pattern(const message_types::SignalHeader& h, std::size_t k)
+{
+    return static_cast<std::uint8_t>(h.cycleCounter * 31u + h.reserved0 + k * 7u);
+}
+
+/**
+ * @brief True if every block of @p slab can be taken again from this thread.
+ *
+ * Drains the classes from the largest down (so nothing spills into a class
+ * that is still counted) and gives everything back afterwards.
+ */
+bool all_blocks_free(slab::Allocator& slab)
+{
+    const slab::Stats before = slab.stats();
+    std::vector<slab::Buffer> held;
+    bool ok = true;
+    for (std::size_t c = slab::kClassCount; c-- > 0;)
+    {
+        std::size_t taken = 0;
+        while (auto b = slab.allocate(slab::class_size(c)))
+        {
+            if (b.capacity() != slab::class_size(c)) break;   // spilled: class c is empty
+            held.push_back(std::move(b));
+            taken++;
+        }
+        if (taken != before.classes[c].blocks)
+        {
+            std::printf("  class %zu B: %zu of %zu blocks free\n", slab::class_size(c), taken,
+                        before.classes[c].blocks);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void check_exhaustion_and_reuse(CheckResult& r)
+{
+    slab::Allocator slab(slab::Config{ 0, 4 });   // 4 blocks per class
+
+    std::vector<slab::Buffer> held;
+    while (auto b = slab.allocate(slab::kMaxBlock)) held.push_back(std::move(b));
+    r.expect(held.size() == 4 && slab.stats().exhausted == 1, "largest class exhausted after its 4 blocks");
+    r.expect(!slab.allocate(slab::kMaxBlock + 1), "request above kMaxBlock refused");
+
+    const std::uint8_t* block = held.back().data();
+    held.pop_back();
+    slab::Buffer again = slab.allocate(slab::kMaxBlock);
+    r.expect(again && again.data() == block, "freed block handed out again");
+
+    slab::Buffer copy = again;
+    again.reset();
+    r.expect(copy.use_count() == 1 && !slab.allocate(slab::kMaxBlock),
+             "block stays taken while a copy holds it");
+    copy.reset();
+    held.clear();
+
+    // Frames spill into larger classes once their own class is empty.
+    std::vector<std::shared_ptr<message_types::Frame>> frames;
+    while (auto f = slab.make_shared<message_types::Frame>()) frames.push_back(std::move(f));
+    const std::size_t capacity = frames.size();
+    frames.clear();
+    while (auto f = slab.make_shared<message_types::Frame>()) frames.push_back(std::move(f));
+    r.expect(capacity > 0 && frames.size() == capacity,
+             "make_shared<Frame> returns nullptr when full, same count after release (" +
+             std::to_string(capacity) + ")");
+    frames.clear();
+    r.expect(all_blocks_free(slab), "every block free again");
+}
+
+void check_foreign_release(CheckResult& r)
+{
+    slab::Allocator slab(slab::Config{ 0, 4 * slab::kCacheDepth });
+
+    std::vector<slab::Buffer> held;
+    while (auto b = slab.allocate(1024)) held.push_back(std::move(b));
+    const std::size_t count = held.size();
+
+    // Released into the other thread's cache, returned when it exits.
+    std::thread([moved = std::move(held)]() mutable { moved.clear(); }).join();
+
+    r.expect(count > 0 && all_blocks_free(slab), "blocks released on another thread come back");
+}
+
+struct Counters
+{
+    std::atomic<std::uint64_t> published{ 0 };
+    std::atomic<std::uint64_t> received{ 0 };
+    std::atomic<std::uint64_t> exhausted{ 0 };
+    std::atomic<std::uint64_t> corrupt{ 0 };
+};
+
+void run_publisher(const SlabRun& run, std::uint8_t id, slab::Allocator& slab, FrameHub::Publisher pub,
+                   const std::atomic<bool>& running, Counters& n)
+{
+    const auto period = run.rateHz > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / run.rateHz))
+        : Clock::duration::zero();
+    auto next = Clock::now();
+    std::uint32_t rng = 0x9E3779B9u * (id + 1u);
+    std::uint16_t seq = 0;
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        rng = rng * 1664525u + 1013904223u;
+        const std::size_t size = 1 + (rng >> 8) % kMaxPayload;
+
+        auto frame = slab.make_shared<message_types::Frame>();
+        if (frame) frame->payload = slab.allocate(size);
+        if (!frame || !frame->payload)
+        {
+            n.exhausted.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+            continue;
+        }
+
+        frame->header = message_types::SignalHeader{ 1, 0, 0, id, seq++, 0 };
+        std::uint8_t* p = frame->payload.data();
+        for (std::size_t k = 0; k < size; ++k) p[k] = pattern(frame->header, k);
+
+        pub.publish(std::move(frame));
+        n.published.fetch_add(1, std::memory_order_relaxed);
+
+        if (period != Clock::duration::zero())
+        {
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    }
+}
+
+void run_subscriber(FrameHub::Receiver rx, const std::atomic<bool>& running, Counters& n)
+{
+    std::uint64_t lastSeen = 0;
+    while (running.load(std::memory_order_relaxed))
+    {
+        const auto m = rx.try_get_newer(lastSeen);
+        if (!m)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+        const message_types::Frame& f = **m;
+        bool ok = f.payload.size() > 0 && f.payload.size() <= kMaxPayload;
+        for (std::size_t k = 0; ok && k < f.payload.size(); ++k) ok = f.payload.data()[k] == pattern(f.header, k);
+        n.received.fetch_add(1, std::memory_order_relaxed);
+        if (!ok) n.corrupt.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void check_hub_traffic(CheckResult& r, const SlabRun& run)
+{
+    // Room for every thread's cache plus the frames alive at once.
+    const std::size_t threads = run.publishers + run.subscribers;
+    slab::Allocator slab(slab::Config{ 256 * 1024, threads * slab::kCacheDepth + run.depth + threads + 8 });
+
+    Counters n;
+    {
+        FrameHub hub(run.depth);
+        std::atomic<bool> running{ true };
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i < run.subscribers; ++i)
+        {
+            workers.emplace_back([&, rx = hub.make_receiver()] { run_subscriber(rx, running, n); });
+        }
+        for (std::size_t i = 0; i < run.publishers; ++i)
+        {
+            workers.emplace_back([&, pub = hub.make_publisher(), i] {
+                run_publisher(run, static_cast<std::uint8_t>(i), slab, pub, running, n);
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(run.durationS));
+        running.store(false, std::memory_order_relaxed);
+        for (auto& t : workers) t.join();
+    }
+
+    std::uint64_t spills = 0;
+    for (const auto& c : slab.stats().classes) spills += c.spills;
+    std::printf("  %zu pub x %zu sub, %.1fs: published %llu received %llu exhausted %llu spills %llu\n",
+                run.publishers, run.subscribers, run.durationS,
+                static_cast<unsigned long long>(n.published.load()),
+                static_cast<unsigned long long>(n.received.load()),
+                static_cast<unsigned long long>(n.exhausted.load()),
+                static_cast<unsigned long long>(spills));
+
+    r.expect(n.published.load() > 0 && n.received.load() > 0, "frames flowed through the hub");
+    r.expect(n.corrupt.load() == 0, "payloads intact (" + std::to_string(n.corrupt.load()) + " corrupt)");
+    r.expect(all_blocks_free(slab), "every block back after the hub and threads are gone");
+}
+
+} // namespace
+
+int slab_check(const SlabRun& run)
+{
+    std::printf("pubsub_stress: slab allocator / Frame hub check\n");
+    CheckResult r;
+    check_exhaustion_and_reuse(r);
+    check_foreign_release(r);
+    check_hub_traffic(r, run);
+    std::printf("slab: %s\n", r.ok ? "PASS" : "FAIL");
+    return r.ok ? 0 : 1;
+}
+
+} // namespace stress
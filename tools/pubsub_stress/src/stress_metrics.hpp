@@ -0,0 +1,160 @@
+/**
+ * @file stress_metrics.hpp
+ * @brief Measurement helpers for the pub/sub stress harness.
+ *
+ * Provides a lock-free latency histogram, process RSS sampling and
+ * per-thread CPU time sampling.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <pthread.h>
+#include <string>
+
+namespace stress {
+
+/**
+ * @class LatencyHistogram
+ * @brief Log-linear histogram of nanosecond values (~6% bucket resolution).
+ *
+ * Each power of two is split into 16 linear sub-buckets. record() is a
+ * single relaxed atomic increment, so one writer and any number of
+ * concurrent readers are safe.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int kSubBits    = 4;
+    static constexpr int kSubBuckets = 1 << kSubBits;
+    static constexpr int kBuckets    = 64 * kSubBuckets;
+
+    using Counts = std::array<std::uint64_t, kBuckets>;
+
+    void record(std::int64_t ns)
+    {
+        counts_[index(ns < 0 ? 0 : static_cast<std::uint64_t>(ns))].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Copy of the current cumulative counts.
+    Counts snapshot() const
+    {
+        Counts c{};
+        for (int i = 0; i < kBuckets; ++i) c[i] = counts_[i].load(std::memory_order_relaxed);
+        return c;
+    }
+
+    /// Bucket index of @p v.
+    static int index(std::uint64_t v)
+    {
+        if (v < kSubBuckets) return static_cast<int>(v);
+        const int msb   = 63 - __builtin_clzll(v);
+        const int shift = msb - kSubBits;
+        const int sub   = static_cast<int>((v >> shift) & (kSubBuckets - 1));
+        return (shift + 1) * kSubBuckets + sub;
+    }
+
+    /// Upper bound (inclusive) of values mapped to bucket @p i.
+    static std::uint64_t upper_bound(int i)
+    {
+        if (i < kSubBuckets) return static_cast<std::uint64_t>(i);
+        const int shift = i / kSubBuckets - 1;
+        const std::uint64_t sub = static_cast<std::uint64_t>(i % kSubBuckets) | kSubBuckets;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    /// Value at quantile @p q (0..1) of @p c, or 0 if @p c is empty.
+    static std::uint64_t percentile(const Counts& c, double q)
+    {
+        std::uint64_t total = 0;
+        for (auto n : c) total += n;
+        if (total == 0) return 0;
+
+        const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; ++i)
+        {
+            seen += c[i];
+            if (seen >= rank) return upper_bound(i);
+        }
+        return upper_bound(kBuckets - 1);
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBuckets> counts_{};
+};
+
+/// Element-wise @p a += @p b.
+inline void accumulate(LatencyHistogram::Counts& a, const LatencyHistogram::Counts& b)
+{
+    for (std::size_t i = 0; i < a.size(); ++i) a[i] += b[i];
+}
+
+/// Element-wise @p a - @p b (counts are cumulative, so never negative).
+inline LatencyHistogram::Counts difference(const LatencyHistogram::Counts& a, const LatencyHistogram::Counts& b)
+{
+    LatencyHistogram::Counts d{};
+    for (std::size_t i = 0; i < a.size(); ++i) d[i] = a[i] - b[i];
+    return d;
+}
+
+/**
+ * @brief Resident set size of this process in KiB (from /proc/self/status).
+ *
+ * @return 0 if the value cannot be read.
+ */
+inline std::uint64_t rss_kib()
+{
+    std::ifstream f("/proc/self/status");
+    std::string key;
+    while (f >> key)
+    {
+        if (key == "VmRSS:")
+        {
+            std::uint64_t kib = 0;
+            f >> kib;
+            return kib;
+        }
+        std::getline(f, key);
+    }
+    return 0;
+}
+
+/**
+ * @class ThreadCpuClock
+ * @brief CPU time of a specific thread, readable from any other thread.
+ *
+ * bind() must be called by the measured thread itself. The clock may only
+ * be read while that thread is alive.
+ */
+class ThreadCpuClock
+{
+public:
+    void bind()
+    {
+        clockid_t id{};
+        if (pthread_getcpuclockid(pthread_self(), &id) == 0)
+        {
+            id_ = id;
+            bound_.store(true, std::memory_order_release);
+        }
+    }
+
+    /// Consumed CPU time in nanoseconds, or 0 if not bound yet.
+    std::int64_t cpu_ns() const
+    {
+        if (!bound_.load(std::memory_order_acquire)) return 0;
+        timespec ts{};
+        if (clock_gettime(id_, &ts) != 0) return 0;
+        return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+private:
+    clockid_t         id_{};
+    std::atomic<bool> bound_{false};
+};
+
+} // namespace stress
@@ -0,0 +1,244 @@
+/**
+ * @file udp_check.cpp
+ * @brief Loopback check of the UDP gateway (pubsub_stress --udp).
+ */
+#include "checks.hpp"
+
+#include "message_pool.hpp"
+#include "udp_gateway.hpp"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace stress {
+
+namespace {
+
+using udp_gateway::Hub;
+using Message = message_payload_one::Message;
+using Clock   = std::chrono::steady_clock;
+
+constexpr std::uint16_t kFrames = 200;
+
+// Poll until the (single) peer of @p rx has delivered @p frames datagrams, or 2 s passed.
+udp_gateway::PeerStats wait_for(udp_gateway::UdpReceiver& rx, Hub::Publisher& pub, std::uint64_t frames)
+{
+    const auto deadline = Clock::now() + std::chrono::seconds(2);
+    while (true)
+    {
+        const auto peers = rx.peer_stats();
+        if (!peers.empty() && peers.front().received >= frames) return peers.front();
+        if (Clock::now() >= deadline) return peers.empty() ? udp_gateway::PeerStats{} : peers.front();
+        rx.poll(pub, std::chrono::milliseconds(10));
+    }
+}
+
+std::shared_ptr<Message> make_message(std::uint16_t cycle)
+{
+    auto msg = std::make_shared<Message>();
+    msg->mutable_header()->set_cyclecounter(cycle);
+    msg->mutable_header()->set_measurementcounter(static_cast<std::uint16_t>(cycle * 3));
+    msg->mutable_header()->set_esigstatus(message_payload_one::SIG_STATUS_OK);
+    msg->set_payload(std::string(cycle % 97, static_cast<char>(cycle)));
+    return msg;
+}
+
+// Gateway sender -> receiver; every received message is recorded by a hub stage.
+void check_round_trip(CheckResult& r)
+{
+    udp_gateway::UdpReceiver receiver(udp_gateway::Endpoint{ "127.0.0.1", 0 });
+    udp_gateway::UdpSender   sender(udp_gateway::Endpoint{ "127.0.0.1", receiver.port() });
+
+    Hub out(1);
+    auto outPub = out.make_publisher();
+    auto outRx  = out.make_receiver();
+
+    Hub in(4);
+    auto inPub = in.make_publisher();
+    std::vector<std::uint16_t> cycles;
+    bool contentOk = true;
+    in.add_stage([&](const Message& m) {
+        const auto c = static_cast<std::uint16_t>(m.header().cyclecounter());
+        cycles.push_back(c);
+        contentOk = contentOk && m.header().measurementcounter() == static_cast<std::uint16_t>(c * 3) &&
+                    m.header().esigstatus() == message_payload_one::SIG_STATUS_OK &&
+                    m.payload() == std::string(c % 97, static_cast<char>(c));
+    });
+
+    // Drain after every batch so the socket buffer cannot overflow.
+    std::uint64_t lastSeen = 0;
+    std::size_t forwarded = 0;
+    for (std::uint16_t i = 0; i < kFrames; ++i)
+    {
+        outPub.publish(make_message(i));
+        forwarded += sender.forward(outRx, lastSeen) ? 1 : 0;
+        if (sender.pending() == 16)
+        {
+            sender.flush();
+            receiver.poll(inPub, std::chrono::milliseconds(0));
+        }
+    }
+    sender.flush();
+    r.expect(!sender.forward(outRx, lastSeen), "forward() without a new publish queues nothing");
+    const auto peer = wait_for(receiver, inPub, kFrames);
+
+    r.expect(forwarded == kFrames, "every publish forwarded (" + std::to_string(forwarded) + ")");
+    r.expect(peer.received == kFrames && cycles.size() == kFrames,
+             "every frame received (" + std::to_string(peer.received) + ")");
+    bool inOrder = cycles.size() == kFrames;
+    for (std::size_t i = 0; inOrder && i < cycles.size(); ++i) inOrder = cycles[i] == i;
+    r.expect(inOrder && contentOk, "headers and payloads intact, in order");
+    r.expect(peer.lost == 0 && peer.reordered == 0 && peer.duplicates == 0, "no loss, reordering or duplicates");
+}
+
+// A message object reused at the same address must still be forwarded.
+void check_recycled_message(CheckResult& r)
+{
+    connection_hub::MessagePool<Message> pool(1);
+
+    udp_gateway::UdpReceiver receiver(udp_gateway::Endpoint{ "127.0.0.1", 0 });
+    udp_gateway::UdpSender   sender(udp_gateway::Endpoint{ "127.0.0.1", receiver.port() });
+
+    Hub out(1);
+    auto outPub = out.make_publisher();
+    auto outRx  = out.make_receiver();
+
+    Hub in(1);
+    auto inPub = in.make_publisher();
+    auto inRx  = in.make_receiver();
+
+    std::uint64_t lastSeen = 0;
+    auto first = pool.acquire();
+    const Message* address = first.get();
+    first->mutable_header()->set_cyclecounter(1);
+    outPub.publish(std::move(first));
+    const bool sentFirst = sender.forward(outRx, lastSeen);
+
+    // Displaces the pooled message (back to the pool) and is conflated away:
+    // the sender does not poll in between.
+    outPub.publish(make_message(2));
+
+    auto third = pool.acquire();
+    r.expect(third.get() == address, "pool hands out the same object again");
+    third->mutable_header()->set_cyclecounter(3);
+    outPub.publish(std::move(third));
+    const bool sentThird = sender.forward(outRx, lastSeen);
+    sender.flush();
+
+    const auto peer = wait_for(receiver, inPub, 2);
+    const auto last = inRx.try_get_latest();
+    r.expect(sentFirst && sentThird && peer.received == 2 && last && (*last)->header().cyclecounter() == 3,
+             "recycled message forwarded");
+}
+
+/**
+ * @brief Plain socket sending bare frame headers with chosen sequence numbers
+ *        to a UdpReceiver, whose hub records what gets published.
+ */
+class RawPeer
+{
+public:
+    RawPeer() : fd_(::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)), in_(1), inPub_(in_.make_publisher())
+    {
+        to_.sin_family = AF_INET;
+        to_.sin_port   = htons(receiver_.port());
+        ::inet_pton(AF_INET, "127.0.0.1", &to_.sin_addr);
+        in_.add_stage([this](const Message&) { published_++; });
+    }
+
+    ~RawPeer() { ::close(fd_); }
+
+    /// Send @p sequences in order; the receiver drains every 16 so none overflow the socket.
+    udp_gateway::PeerStats send(const std::vector<std::uint32_t>& sequences)
+    {
+        for (std::size_t i = 0; i < sequences.size(); ++i)
+        {
+            udp_gateway::FrameHeader h{};
+            h.magic    = udp_gateway::kFrameMagic;
+            h.sequence = sequences[i];
+            std::uint8_t frame[udp_gateway::kFrameHeaderSize];
+            udp_gateway::encode_header(h, frame);
+            ::sendto(fd_, frame, sizeof(frame), 0, reinterpret_cast<const sockaddr*>(&to_), sizeof(to_));
+            sent_++;
+            if (i % 16 == 15) receiver_.poll(inPub_, std::chrono::milliseconds(0));
+        }
+        const auto p = wait_for(receiver_, inPub_, sent_);
+        std::printf("  peer %s: received %llu published %zu lost %llu reordered %llu duplicates %llu "
+                    "stale %llu restarts %llu dropped %llu last %u\n",
+                    p.peer.c_str(), static_cast<unsigned long long>(p.received), published_,
+                    static_cast<unsigned long long>(p.lost), static_cast<unsigned long long>(p.reordered),
+                    static_cast<unsigned long long>(p.duplicates), static_cast<unsigned long long>(p.stale),
+                    static_cast<unsigned long long>(p.restarts), static_cast<unsigned long long>(p.dropped),
+                    p.lastSequence);
+        return p;
+    }
+
+    std::size_t published() const { return published_; }
+
+private:
+    udp_gateway::UdpReceiver receiver_{ udp_gateway::Endpoint{ "127.0.0.1", 0 } };
+    int                      fd_;
+    sockaddr_in              to_{};
+    Hub                      in_;
+    Hub::Publisher           inPub_;
+    std::size_t              sent_      = 0;
+    std::size_t              published_ = 0;
+};
+
+// Hand-crafted sequence numbers from a plain socket.
+void check_accounting(CheckResult& r)
+{
+    RawPeer peer;
+
+    // 4 never arrives, 2 arrives late, then 2 and 1 again.
+    const std::vector<std::uint32_t> sequences = { 0, 1, 3, 2, 2, 5, 1 };
+    const auto p = peer.send(sequences);
+    r.expect(p.received == sequences.size() && p.lastSequence == 5, "all datagrams accounted");
+    r.expect(p.lost == 1, "lost: only sequence 4");
+    r.expect(p.reordered == 1, "reordered: only the first late 2");
+    r.expect(p.duplicates == 2, "duplicates: second 2 and second 1, lost count untouched");
+    r.expect(peer.published() == 4 && p.dropped == 3, "only 0, 1, 3, 5 published; late and repeated dropped");
+}
+
+// A frame from before the duplicate window is stale; a jump back to 0 is a restarted sender.
+void check_restart(CheckResult& r)
+{
+    RawPeer peer;
+
+    std::vector<std::uint32_t> sequences;
+    for (std::uint32_t s = 0; s < 200; ++s) sequences.push_back(s);
+    sequences.push_back(120);                        // 79 behind: stale
+    for (std::uint32_t s = 0; s < 50; ++s) sequences.push_back(s);   // sender restarted
+    sequences.push_back(49);                         // duplicate in the new stream
+
+    const auto p = peer.send(sequences);
+    r.expect(p.received == sequences.size(), "all datagrams accounted");
+    r.expect(p.stale == 1 && p.restarts == 1, "one stale frame, one restart");
+    r.expect(p.lastSequence == 49 && p.lost == 0 && p.reordered == 0 && p.duplicates == 1,
+             "new stream followed: no loss or reordering after it");
+    r.expect(peer.published() == 250 && p.dropped == 2, "restarted stream published, stale and duplicate dropped");
+}
+
+} // namespace
+
+int udp_check()
+{
+    std::printf("pubsub_stress: UDP gateway loopback check\n");
+    CheckResult r;
+    check_round_trip(r);
+    check_recycled_message(r);
+    check_accounting(r);
+    check_restart(r);
+    std::printf("udp: %s\n", r.ok ? "PASS" : "FAIL");
+    return r.ok ? 0 : 1;
+}
+
+} // namespace stress
@@ -0,0 +1,128 @@
+/**
+ * @file trace.hpp
+ * @brief Scoped hot-path tracing with Chrome trace / Perfetto JSON output.
+ *
+ * TRACE_SCOPE("name") records a begin/end span with nanosecond timestamps
+ * into a ring buffer owned by the calling thread. Spans are only recorded
+ * while tracing is enabled at runtime; when disabled a span costs one
+ * relaxed atomic load. Building with PROJECT_TRACING=0 removes every span
+ * at compile time.
+ *
+ * A thread's buffer is freed once the thread has exited and a dump (or
+ * clear()) has taken its spans; at most 16 exited threads wait for a dump,
+ * older ones are dropped, so thread churn does not grow memory.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#ifndef PROJECT_TRACING
+#define PROJECT_TRACING 1
+#endif
+
+#ifndef PROJECT_TRACE_EVENTS_PER_THREAD
+#define PROJECT_TRACE_EVENTS_PER_THREAD 4096
+#endif
+
+namespace trace {
+
+/// Number of spans retained per thread; older spans are overwritten.
+inline constexpr std::uint64_t kEventsPerThread = PROJECT_TRACE_EVENTS_PER_THREAD;
+
+static_assert((kEventsPerThread & (kEventsPerThread - 1)) == 0,
+              "PROJECT_TRACE_EVENTS_PER_THREAD must be a power of two");
+
+namespace detail {
+/// Runtime switch read by every span.
+inline std::atomic<bool> g_enabled{false};
+
+/// Monotonic clock in nanoseconds (never 0 in practice).
+std::int64_t now_ns();
+
+/// Append a finished span to the calling thread's ring buffer.
+void record(const char* name, std::int64_t begin_ns, std::int64_t end_ns);
+} // namespace detail
+
+/// Start or stop recording spans. Cheap; may be called from any thread.
+inline void set_enabled(bool on) { detail::g_enabled.store(on, std::memory_order_relaxed); }
+
+/// True if spans are currently being recorded.
+inline bool enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+
+/**
+ * @brief Write every retained span as Chrome trace JSON ("X" complete events).
+ *
+ * Can be called while other threads keep tracing; spans overwritten during
+ * the dump are skipped. Buffers of threads that had exited are freed
+ * afterwards, so their spans appear in one dump only.
+ *
+ * @return Number of spans written.
+ */
+std::size_t dump_chrome_json(std::ostream& os);
+
+/**
+ * @brief Write the trace to @p path.
+ *
+ * @return false if the file could not be opened.
+ */
+bool dump_chrome_json(const std::string& path);
+
+/// Drop every retained span.
+void clear();
+
+/**
+ * @brief Dump the trace to @p path every time signal @p sig is received.
+ *
+ * Blocks @p sig in the calling thread and starts a helper thread that waits
+ * for it with sigwait(). Must be called before other threads are created so
+ * they inherit the blocked signal mask. When several helpers wait on
+ * different signals (alloc_tracker::report_on_signal()), block all of them
+ * with pthread_sigmask() before starting the first helper; otherwise an
+ * earlier helper leaves a later signal unblocked and it may be delivered
+ * there, with its default action.
+ */
+void dump_on_signal(int sig, const std::string& path);
+
+/**
+ * @class Span
+ * @brief RAII span; prefer the TRACE_SCOPE macro.
+ *
+ * @p name must have static storage duration (a string literal).
+ */
+class Span
+{
+public:
+    explicit Span(const char* name)
+        : name_(name)
+        , begin_(enabled() ? detail::now_ns() : 0)
+    {
+    }
+
+    ~Span()
+    {
+        if (begin_ != 0) detail::record(name_, begin_, detail::now_ns());
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char*  name_;
+    std::int64_t begin_;
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if PROJECT_TRACING
+/// Record a span named @p name covering the rest of the enclosing scope.
+#define TRACE_SCOPE(name) ::trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
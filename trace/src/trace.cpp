@@ -0,0 +1,262 @@
+/**
+ * @file trace.cpp
+ * @brief Per-thread span buffers and Chrome trace JSON export.
+ */
+#include "trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <pthread.h>
+#include <thread>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+/**
+ * @brief One span slot. Fields are atomics so a concurrent dump never races
+ *        with the owning thread; a torn slot is detected and skipped instead.
+ */
+struct Event
+{
+    std::atomic<const char*>  name{nullptr};
+    std::atomic<std::int64_t> begin{0};
+    std::atomic<std::int64_t> end{0};
+};
+
+/**
+ * @brief Ring of spans written only by its owning thread.
+ */
+struct ThreadBuffer
+{
+    explicit ThreadBuffer(std::uint32_t id) : tid(id) {}
+
+    const std::uint32_t        tid;
+    std::atomic<std::uint64_t> head{0};   ///< Number of spans ever written.
+    bool                       exited = false;   ///< Owner gone; guarded by Registry::m.
+    Event                      events[kEventsPerThread];
+};
+
+/// Exited threads whose spans are kept for the next dump; older ones are dropped.
+constexpr std::size_t kMaxExitedBuffers = 16;
+
+/**
+ * @brief Buffers of live threads, plus those of exited threads until a dump
+ *        has written them (at most kMaxExitedBuffers).
+ */
+struct Registry
+{
+    std::mutex                                 m;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;   ///< In registration order.
+    std::uint32_t                              nextTid = 1;
+};
+
+Registry& registry()
+{
+    static Registry r;
+    return r;
+}
+
+/// Reference point for exported timestamps.
+const std::int64_t g_epoch_ns = detail::now_ns();
+
+/// Registers the calling thread's buffer and hands it back when the thread exits.
+class BufferOwner
+{
+public:
+    BufferOwner()
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lk(r.m);
+        buffer_ = std::make_shared<ThreadBuffer>(r.nextTid++);
+        r.buffers.push_back(buffer_);
+    }
+
+    ~BufferOwner()
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lk(r.m);
+        buffer_->exited = true;
+        if (buffer_->head.load(std::memory_order_relaxed) == 0)
+        {
+            r.buffers.erase(std::find(r.buffers.begin(), r.buffers.end(), buffer_));
+            return;
+        }
+
+        // Bound the memory of thread churn nobody dumps: drop the oldest exited.
+        const auto exited = [](const std::shared_ptr<ThreadBuffer>& b) { return b->exited; };
+        while (static_cast<std::size_t>(std::count_if(r.buffers.begin(), r.buffers.end(), exited)) >
+               kMaxExitedBuffers)
+        {
+            r.buffers.erase(std::find_if(r.buffers.begin(), r.buffers.end(), exited));
+        }
+    }
+
+    BufferOwner(const BufferOwner&) = delete;
+    BufferOwner& operator=(const BufferOwner&) = delete;
+
+    ThreadBuffer& buffer() { return *buffer_; }
+
+private:
+    std::shared_ptr<ThreadBuffer> buffer_;
+};
+
+// First span on a thread allocates and registers its buffer.
+ThreadBuffer& this_thread_buffer()
+{
+    thread_local BufferOwner owner;
+    return owner.buffer();
+}
+
+// Forget buffers of exited threads that are in @p written; a dump holds its own references.
+void release_exited(const std::vector<std::shared_ptr<ThreadBuffer>>& written)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.m);
+    r.buffers.erase(std::remove_if(r.buffers.begin(), r.buffers.end(),
+                                   [&](const std::shared_ptr<ThreadBuffer>& b) {
+                                       return std::find(written.begin(), written.end(), b) != written.end();
+                                   }),
+                    r.buffers.end());
+}
+
+void write_json_string(std::ostream& os, const char* s)
+{
+    os << '"';
+    for (; *s; ++s)
+    {
+        if (*s == '"' || *s == '\\') os << '\\';
+        os << *s;
+    }
+    os << '"';
+}
+
+// Chrome expects microseconds; keep nanosecond precision as a fraction.
+void write_us(std::ostream& os, std::int64_t ns)
+{
+    if (ns < 0) { os << '-'; ns = -ns; }
+    const std::int64_t frac = ns % 1000;
+    os << ns / 1000 << '.' << static_cast<char>('0' + frac / 100)
+       << static_cast<char>('0' + (frac / 10) % 10) << static_cast<char>('0' + frac % 10);
+}
+
+} // namespace
+
+std::int64_t detail::now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void detail::record(const char* name, std::int64_t begin_ns, std::int64_t end_ns)
+{
+    ThreadBuffer& tb = this_thread_buffer();
+    const std::uint64_t idx = tb.head.load(std::memory_order_relaxed);
+    Event& e = tb.events[idx & (kEventsPerThread - 1)];
+    e.name.store(name, std::memory_order_relaxed);
+    e.begin.store(begin_ns, std::memory_order_relaxed);
+    e.end.store(end_ns, std::memory_order_relaxed);
+    tb.head.store(idx + 1, std::memory_order_release);
+}
+
+std::size_t dump_chrome_json(std::ostream& os)
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::vector<std::shared_ptr<ThreadBuffer>> exited;   // complete: their owners write no more
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lk(r.m);
+        buffers = r.buffers;
+        for (const auto& tb : r.buffers)
+        {
+            if (tb->exited) exited.push_back(tb);
+        }
+    }
+
+    struct Copy { const char* name; std::int64_t begin; std::int64_t end; std::uint64_t idx; };
+    std::vector<Copy> spans;
+    spans.reserve(kEventsPerThread);
+
+    std::size_t written = 0;
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (const auto& tb : buffers)
+    {
+        spans.clear();
+        const std::uint64_t head  = tb->head.load(std::memory_order_acquire);
+        const std::uint64_t first = head > kEventsPerThread ? head - kEventsPerThread : 0;
+        for (std::uint64_t i = first; i < head; ++i)
+        {
+            const Event& e = tb->events[i & (kEventsPerThread - 1)];
+            spans.push_back({ e.name.load(std::memory_order_relaxed),
+                              e.begin.load(std::memory_order_relaxed),
+                              e.end.load(std::memory_order_relaxed), i });
+        }
+
+        // Slots the owner may have rewritten while we copied are not trustworthy.
+        const std::uint64_t after = tb->head.load(std::memory_order_acquire);
+        const std::uint64_t valid = after >= kEventsPerThread ? after - kEventsPerThread + 1 : 0;
+
+        for (const Copy& c : spans)
+        {
+            if (c.idx < valid || c.name == nullptr) continue;
+            os << (written++ ? ",\n" : "\n") << "{\"name\":";
+            write_json_string(os, c.name);
+            os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << tb->tid << ",\"ts\":";
+            write_us(os, c.begin - g_epoch_ns);
+            os << ",\"dur\":";
+            write_us(os, c.end - c.begin);
+            os << '}';
+        }
+    }
+    os << "\n]}\n";
+    release_exited(exited);
+    return written;
+}
+
+bool dump_chrome_json(const std::string& path)
+{
+    std::ofstream f(path, std::ios::trunc);
+    if (!f) return false;
+    dump_chrome_json(f);
+    return static_cast<bool>(f);
+}
+
+void clear()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.m);
+    r.buffers.erase(std::remove_if(r.buffers.begin(), r.buffers.end(),
+                                   [](const std::shared_ptr<ThreadBuffer>& b) { return b->exited; }),
+                    r.buffers.end());
+    for (const auto& tb : r.buffers)
+    {
+        for (Event& e : tb->events) e.name.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+void dump_on_signal(int sig, const std::string& path)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, sig);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+    std::thread([set, path] {
+        for (;;)
+        {
+            int got = 0;
+            if (sigwait(&set, &got) == 0)
+            {
+                dump_chrome_json(path);
+            }
+        }
+    }).detach();
+}
+
+} // namespace trace